@@ -36,8 +36,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ffd.h"
 #include "ffd_node.h"
+#include "ffd_program.h"
+#include "ffd_expr.h"
+#include "ffd_map_stream.h"
+#include "ffd_projection.h"
 
 #include <new>
+#include <string.h>
 
 FFD_NAMESPACE
 
@@ -99,29 +104,41 @@ bool FFD::SNode::ParseMachType(FFDParser & parser)
     parser.SkipLineWhitespace ();
     // name
     Name = static_cast<String &&>(parser.ReadSymbol ());
-    Dbg << "MachType: Symbol: " << Name << EOL;
+    DbgD << "MachType: Symbol: " << Name << EOL;
+    Index ();
     parser.SkipLineWhitespace ();
     // size or alias
     if (parser.SymbolValid1st ()) { // alias
         String alias = static_cast<String &&>(parser.ReadSymbol ());
-        Dbg << "MachType: Alias: " << alias << EOL;
+        DbgD << "MachType: Alias: " << alias << EOL;
         auto an = NodeByName (alias);
         FFD_ENSURE_FFD(an != nullptr, "The alias must exist prior whats "
             "referencing it. I know you want infinite loops; plenty elsewhere.")
         Size = an->Size;
         Signed = an->Signed;
+        Order = an->Order;
     }
     else {// size
         if (parser.AtFp ())
             Fp = true, parser.SkipOneByte ();
         Size = parser.ParseIntLiteral ();
         if (Size < 0) { Signed = true; Size = -Size; }
-        Dbg << "MachType: " << Size << " bytes, " << (Fp ? "floating-point"
+        DbgD << "MachType: " << Size << " bytes, " << (Fp ? "floating-point"
             : (Signed ? "signed" : "unsigned")) << EOL;
     }
     if (parser.IsEol ()) return true; // completed
-    // There could be an expression
     parser.SkipLineWhitespace ();
+    // There could be a byte order
+    if (parser.SymbolValid1st ()) {
+        String order = static_cast<String &&>(parser.ReadSymbol ());
+        DbgD << "MachType: byte order: " << order << EOL;
+        if ("big" == order) Order = FFD::SByteOrder::Big;
+        else if ("little" == order) Order = FFD::SByteOrder::Little;
+        else FFD_ENSURE_FFD(0, "Byte order: \"big\" or \"little\"")
+        if (parser.IsEol ()) return true;
+        parser.SkipLineWhitespace ();
+    }
+    // There could be an expression
     if (parser.AtExprStart ())
         Expr = static_cast<List<FFDParser::ExprToken> &&>(
             parser.TokenizeExpression ());
@@ -148,12 +165,13 @@ bool FFD::SNode::ParseAttribute(FFDParser & parser)
 //np ReadExpression (open: '[', close: ']');
     Attribute = static_cast<String &&>(parser.ReadExpression ('[', ']'));
     parser.SkipCommentWhitespaceSequence ();
-    Dbg << "Attribute: " << Attribute << EOL;
+    DbgD << "Attribute: " << Attribute << EOL;
     return true;
 }
 
 FFD::SNode::~SNode()
 {
+    FFD_DESTROY_OBJECT(CompiledExpr, FFDExpr)
     for (int i = 0; i < Fields.Count (); i++)
         FFD_DESTROY_NESTED_OBJECT(Fields[i], FFD::SNode, SNode)
 }
@@ -169,22 +187,22 @@ bool FFD::SNode::ParseStruct(FFDParser & parser)
     auto p = parser.Tell ();
     auto s = parser.TokenizeUntilWhiteSpace ("<>");
     FFD_ENSURE(s.Count () > 0, "TokenizeUntilWhiteSpace returned 0 tokens")
-    Dbg << "Struct: " << s[0] << ": ";
+    DbgD << "Struct: " << s[0] << ": ";
     if (s.Count () > 1) {
         parser.SetCurrent (p); //TODO come on
         s = parser.TokenizeUntilWhiteSpace ("<>,");
         Name = s[0];
-        Dbg << "parametrized: \"";
-            PS.Add (PSParam {static_cast<String &&>(s[1])}); Dbg <<  "\"";
+        DbgD << "parametrized: \"";
+            PS.Add (PSParam {static_cast<String &&>(s[1])}); DbgD <<  "\"";
         for (int i = 2; i < s.Count (); i++)
-            Dbg << ", \"", PS.Add (PSParam {static_cast<String &&>(s[i])}),
-                Dbg << "\"";
+            DbgD << ", \"", PS.Add (PSParam {static_cast<String &&>(s[i])}),
+                DbgD << "\"";
     } else {
         parser.SetCurrent (p); //TODO come on
 //np ReadSymbol (stop_at: ':', allow_dot: true);
         Name = static_cast<String &&>(parser.ReadSymbol (':', true));
         if (parser.AtVListSep ()) {
-            Dbg << "variadic list item" << EOL;
+            DbgD << "variadic list item" << EOL;
             VListItem = true;
             parser.SkipOneByte ();
             FFD_ENSURE_FFD(parser.HasMoreData (), "Incomplete value-list")
@@ -193,7 +211,8 @@ bool FFD::SNode::ParseStruct(FFDParser & parser)
             // Dbg << "Struct: ValueList: " << ValueList << EOL;
         }
     }
-    Dbg << EOL;
+    DbgD << EOL;
+    Index ();
     // skip remaining white-space(s) and comment(s)
     FFD_ENSURE_FFD(parser.HasMoreData (), "Incomplete struct")// struct .*EOF
     parser.SkipCommentWhitespaceSequence ();
@@ -243,7 +262,7 @@ bool FFD::SNode::ParseCompositeField(FFDParser & parser, int j)
     Composite = true;
     DTypeName = static_cast<String &&>(parser.StringAt (j, parser.Tell ()-j));
     Name = "{composite}";
-    Dbg << "Field: composite. DTypeName: " << DTypeName << EOL;
+    DbgD << "Field: composite. DTypeName: " << DTypeName << EOL;
     if (parser.IsEol ()) return true;
     // if there is no expr - restore it, so FFD::SNode::ParseField() can handle
     // SkipLineWhitespace(); use case: {Composite} {Comment}
@@ -287,7 +306,7 @@ bool FFD::SNode::ParseField(FFDParser & parser)
             // resolve: pass 1
             String hash_key_type = static_cast<String &&>(
                 parser.StringAt (j, parser.Tell ()-1-j));
-            Dbg << "Field: hash. Key type: " << hash_key_type << EOL;
+            DbgD << "Field: hash. Key type: " << hash_key_type << EOL;
             DType = Base->NodeByName (hash_key_type); // could be conditional
             parser.SkipOneByte (); // move after "<>"
             FFD_ENSURE_FFD(parser.HasMoreData (), "wrong hash field") // .*<>EOF
@@ -303,12 +322,12 @@ bool FFD::SNode::ParseField(FFDParser & parser)
                 "wrong hash field")
             parser.SkipOneByte ();
             FFD_ENSURE_FFD(parser.HasMoreData (), "wrong hash field") // .*[]EOF
-            Dbg << "Field: hash. HashType: " << HashType << EOL;
+            DbgD << "Field: hash. HashType: " << HashType << EOL;
             // Name - required; hash fields can't be nameless
             parser.SkipLineWhitespace ();
             // Can't be an array.
             Name = static_cast<String &&>(parser.ReadSymbol ());
-            Dbg << "Field: hash. Name: " << Name << EOL;
+            DbgD << "Field: hash. Name: " << Name << EOL;
             break;
         }
         else if (parser.AtVariadicStart ()) { // variadic
@@ -317,7 +336,7 @@ bool FFD::SNode::ParseField(FFDParser & parser)
             FFD_ENSURE_FFD(parser.HasMoreData (), "Wrong variadic field") //.EOF
             parser.SkipLineWhitespace ();
             Name = static_cast<String &&>(parser.ReadSymbol ('\0', true));
-            Dbg << "Field: variadic. Name: " << Name << EOL;
+            DbgD << "Field: variadic. Name: " << Name << EOL;
             break;
         }
         else if (parser.IsEol ()) // compositeEOL
@@ -330,7 +349,7 @@ bool FFD::SNode::ParseField(FFDParser & parser)
             parser.SetCurrent (p);
             DTypeName =
                 static_cast<String &&>(parser.StringAt (j, parser.Tell ()-j));
-            Dbg << "Field: type: " << DTypeName << EOL;
+            DbgD << "Field: type: " << DTypeName << EOL;
             DType = Base->NodeByName (DTypeName); // resolve: pass 1
             parser.SkipLineWhitespace ();
             Name = static_cast<String &&>(parser.ReadSymbol ('['));
@@ -352,8 +371,9 @@ bool FFD::SNode::ParseField(FFDParser & parser)
                         FFD_ENSURE(parser.AtArrEnd (), "wrong arr dim")
                         parser.SkipOneByte (); // ']'.Next()
                     }
-                    Dbg << "Field: array[" << arr << "]= ";
-                    Arr[arr].DbgPrint (); Dbg << EOL;
+                    if (DBG_ON(FFD_DBG_DEBUG))
+                        Dbg << "Field: array[" << arr << "]= ",
+                        Arr[arr].DbgPrint (), Dbg << EOL;
                     if (! parser.HasMoreData ()) break; // foo[.*]EOF
                     if (! parser.AtArrStart ()) break;
                     else {
@@ -365,7 +385,7 @@ bool FFD::SNode::ParseField(FFDParser & parser)
                         "incomplete array") // [EOF
                 }
             }// array
-            Dbg << "Field: name: " << Name << EOL;
+            DbgD << "Field: name: " << Name << EOL;
             break;
         }// (parser.IsLineWhitespace ())
     }// (;; i++)
@@ -388,20 +408,20 @@ bool FFD::SNode::ParseConst(FFDParser & parser)
 
     parser.SkipLineWhitespace ();
     Name = static_cast<String &&>(parser.ReadSymbol ());
-    Dbg << "Const: name: " << Name << EOL;
+    DbgD << "Const: name: " << Name << EOL;
     parser.SkipLineWhitespace ();
     // int or string
     if (parser.AtDoubleQuote ()) {
         Const = FFD::SConstType::Text;
         StringLiteral = static_cast<String &&>(parser.ReadStringLiteral ());
-        Dbg << "Const: string: " << StringLiteral << EOL;
+        DbgD << "Const: string: " << StringLiteral << EOL;
     }
     else {
         Const = FFD::SConstType::Int;
         IntLiteral = parser.ParseIntLiteral ();
         Size = 4;
         if (IntLiteral < 0) Signed = true;
-        Dbg << "Const: integer: " << IntLiteral << EOL;
+        DbgD << "Const: integer: " << IntLiteral << EOL;
     }
     if (parser.IsEol ()) { parser.SkipEol (); return true; }
     parser.SkipLineWhitespace ();
@@ -422,10 +442,11 @@ bool FFD::SNode::ParseEnum(FFDParser & parser)
 
     parser.SkipLineWhitespace ();
     Name = static_cast<String &&>(parser.ReadSymbol ());
-    Dbg << "Enum: name: " << Name << EOL;
+    DbgD << "Enum: name: " << Name << EOL;
+    Index ();
     parser.SkipLineWhitespace ();
     DTypeName = static_cast<String &&>(parser.ReadSymbol ());
-    Dbg << "Enum: type: " << DTypeName << EOL;
+    DbgD << "Enum: type: " << DTypeName << EOL;
     DType = NodeByName (DTypeName); // resolve: pass 1
     FFD_ENSURE_FFD(nullptr != DType, "Enum shall resolve to a machine type")
     Size = DType->Size;
@@ -452,7 +473,7 @@ bool FFD::SNode::ParseEnum(FFDParser & parser)
         else {
             EnumItem itm {auto_value};
             itm.Name = static_cast<String &&>(parser.ReadSymbol ());
-            Dbg << "EnumItem: Name: " << itm.Name << EOL;
+            DbgD << "EnumItem: Name: " << itm.Name << EOL;
             if (parser.IsEol ()) parser.SkipEol (); // {name}EOL
             else {
                 parser.SkipLineWhitespace ();
@@ -460,7 +481,7 @@ bool FFD::SNode::ParseEnum(FFDParser & parser)
                     parser.SkipCommentWhitespaceSequence ();
                 else {
                     auto_value = itm.Value = parser.ParseIntLiteral ();
-                    Dbg << "EnumItem: Value: " << itm.Value << EOL;
+                    DbgD << "EnumItem: Value: " << itm.Value << EOL;
                     if (parser.IsEol ()) parser.SkipEol (); // {name} {value}
                     else {
                         if (parser.AtExprStart ()) // {name} {value} {expr}
@@ -486,6 +507,7 @@ bool FFD::SNode::ParseEnum(FFDParser & parser)
 
 FFD::~FFD()
 {
+    FFD_DESTROY_OBJECT(_program, FFDProgram)
     while (_tail) {
         auto dnode = _tail;
         _tail = _tail->Prev;
@@ -495,26 +517,20 @@ FFD::~FFD()
     _head = _tail;
 }
 
-//LATER use a hash
-FFD::SNode * FFD::SNode::NodeByName(const String & query)
+FFD::SNode * FFD::SNode::NodeByName(const String & query,
+    const ParseContext * ctx)
 {
-    FFD::SNode * result = {};
-    WalkBackwards([&](FFD::SNode * node) {
-        if (node->Name == query && node->Usable ()) {
-            result = node;
-            return false;
-        }
-        return true;
+    return FindByName (query, [ctx](FFD::SNode * node) {
+        return node->Usable (ctx); });
+}
+
+FFD::SNode * FFD::SNode::FindVListItem(const String & dname, int value,
+    const ParseContext * ctx)
+{//TODO more than one is an error: report it
+    return FindByName (dname, [&](FFD::SNode * node) {
+        return node->VListItem && node->Usable (ctx)
+            && node->InValueList (value);
     });
-    if (nullptr == result && Next)
-        Next->WalkForward([&](FFD::SNode * node) {
-            if (node->Name == query && node->Usable ()) {
-                result = node;
-                return false;
-            }
-            return true;
-        });
-    return result;
 }
 
 FFD::EnumItem * FFD::SNode::FindEnumItem(const String & name)
@@ -526,8 +542,18 @@ FFD::EnumItem * FFD::SNode::FindEnumItem(const String & name)
 
 List<FFD::SNode *> FFD::SNode::NodesByName(const String & query)
 {
-    Dbg << "FFD::SNode::NodesByName(" << query << ")" << " at " << Name << EOL;
+    DbgT << "FFD::SNode::NodesByName(" << query << ")" << " at " << Name
+        << EOL;
     List<FFD::SNode *> result = {};
+    if (Symbols) { // same order as the walk below
+        auto list = Symbols->Find (query);
+        if (nullptr == list) return result;
+        for (int i = list->Count () - 1; i >= 0; i--)
+            if ((*list)[i]->Ordinal <= Ordinal) result.Add ((*list)[i]);
+        for (int i = 0; i < list->Count (); i++)
+            if ((*list)[i]->Ordinal > Ordinal) result.Add ((*list)[i]);
+        return static_cast<List<FFD::SNode *> &&>(result);
+    }
     WalkBackwards([&](FFD::SNode * node) {
         if (node->Name == query) result.Add (node);
         return true;
@@ -564,13 +590,13 @@ void FFD::SNode::ResolveTypes()
 
     if (DType || NoDType ()) return;
     if (DTypeName.Empty ()) {
-        Dbg << "neither dtype nor dtypename: \"" << Name << "\"" << EOL;
+        DbgD << "neither dtype nor dtypename: \"" << Name << "\"" << EOL;
         return;
     }
     auto ps =  DTypeName.Split ('<'); // TODO implement the multi-delim. one
     if (ps.Count () > 1) { // parametrized struct TODO 1000 checks
         DTypeName = ps[0]; // point to the parametrized struct
-        Dbg << " FieldSNode<>" << Base->Name << "." << Name << ": resolving "
+        DbgD << " FieldSNode<>" << Base->Name << "." << Name << ": resolving "
             << DTypeName << EOL;
         ps = ps[1].Split ('>');
         ps = ps[0].Split (',');
@@ -579,7 +605,7 @@ void FFD::SNode::ResolveTypes()
         //       root sub-nodes; or even better: TypeByName ()
         //TODO what happens if !Base, and if DTypeName.Empty()?
         for (int i = 0; i < ps.Count (); i++)
-            Dbg << "  - ", PS.Add ({static_cast<String &&>(ps[i]), this,
+            DbgD << "  - ", PS.Add ({static_cast<String &&>(ps[i]), this,
                 static_cast<String &&>(foo ? foo->PS[i].Name : "")});
     }
     DType = Base ? Base->NodeByName (DTypeName)
@@ -589,6 +615,57 @@ static void resolve_all_types(FFD::SNode * n)
 {
     n->WalkForward ([&](FFD::SNode * nn){ nn->ResolveTypes (); return true; });
 }
+static void compile_expr(FFD::SNode * n, FFD::SNode * head)
+{
+    if (! n->HasExpr ()) return;
+    FFDExpr * e {};
+    FFD_CREATE_OBJECT(e, FFDExpr) {n, head};
+    if (e->Valid ()) n->CompiledExpr = e;
+    else FFD_DESTROY_OBJECT(e, FFDExpr)
+}
+void FFD::NumberNodes()
+{
+    _node_count = 0;
+    _head->WalkForward ([&](FFD::SNode * n) {
+        n->Id = _node_count++;
+        n->NameId = _names.Add (n), n->Names = &_names;
+        for (auto f : n->Fields)
+            f->Id = _node_count++,
+            f->NameId = _names.Add (f), f->Names = &_names;
+        n->NumberSlots ();
+        return true;
+    });
+}
+
+void FFD::SNode::NumberSlots()
+{
+    _slots = List<SlotEntry> {}, SlotCount = 0;
+    if (Fields.Empty ()) return;
+    int size = 4;
+    while (size < 2 * Fields.Count ()) size <<= 1;
+    for (int i = 0; i < size; i++) _slots.Add (SlotEntry {});
+    for (auto f : Fields) {
+        f->Slot = SlotOf (f->NameId);
+        if (f->Slot >= 0) continue;
+        int i = f->NameId & (size - 1);
+        while (_slots[i].NameId >= 0) i = (i + 1) & (size - 1);
+        _slots[i].NameId = f->NameId, _slots[i].Slot = f->Slot = SlotCount++;
+    }
+}
+
+FFD::ParseContext::ParseContext(const FFD & ffd)
+{
+    for (int i = 0; i < ffd._node_count; i++) _slots.Add (Slot {});
+}
+
+void FFD::CompileExpressions()
+{
+    _head->WalkForward ([&](FFD::SNode * n) {
+        compile_expr (n, _head);
+        for (auto f : n->Fields) compile_expr (f, _head);
+        return true;
+    });
+}
 
 FFD::FFD(const byte * buf, int len)
 {
@@ -599,8 +676,10 @@ FFD::FFD(const byte * buf, int len)
             "Wrong chars at description")
     }
 
-    Dbg << "TB LR parsing " << len << " bytes ffd" << EOL;
+    _text_len = len, _text_checksum = Checksum (buf, len);
+    DbgD << "TB LR parsing " << len << " bytes ffd" << EOL;
     FFDParser parser {buf, len};
+    int ordinal {};
     for (int chk = 0; parser.HasMoreData (); chk++) {
         if (parser.IsWhitespace ()) parser.SkipWhitespace ();
         // Skipped, for now
@@ -617,12 +696,16 @@ FFD::FFD(const byte * buf, int len)
                 _tail->Next = node;
                 _tail = node;
             }
+            // Indexed as they're parsed: "resolve: pass 1" looks them up too.
+            node->Ordinal = ordinal++;
+            node->Symbols = &_symbols;
             node->Parse (parser);
+            node->Index (); // the unnamed ones
             if (node->IsRoot ()) {
                 FFD_ENSURE_FFD(nullptr == _root, "Multiple formats in a "
                     "single description aren't supported yet")
                 _root = node;
-                Dbg << "Ready to parse: " << node->Name << EOL;
+                DbgD << "Ready to parse: " << node->Name << EOL;
             }
         }
         FFD_ENSURE_FFD(chk < len, "infinite loop")
@@ -631,18 +714,162 @@ FFD::FFD(const byte * buf, int len)
     // 2. Fasten DType - only those with "! Expr.Empty ()" shall remain null -
     //    they're being resolved at "runtime".
     resolve_all_types (_head);
-    print_tree (_head);
+    ResolveByteOrder ();
+    // 3. Pre-process the expressions: they're evaluated per file.
+    NumberNodes ();
+    CompileExpressions ();
+    if (DBG_ON(FFD_DBG_DEBUG)) print_tree (_head);
 }// FFD::FFD()
 
-FFDNode * FFD::File2Tree(Stream & fh2)
+void FFD::ResolveByteOrder()
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    auto const HOST = SByteOrder::Big;
+#else
+    auto const HOST = SByteOrder::Little;
+#endif
+    auto order = SByteOrder::Default;
+    _head->WalkForward ([&](SNode * n) {
+        auto was = order;
+        if (n->IsAttribute () && "[ByteOrder(big)]" == n->Attribute)
+            order = SByteOrder::Big;
+        else if (n->IsAttribute () && "[ByteOrder(little)]" == n->Attribute)
+            order = SByteOrder::Little;
+        else return true;
+        // global: where it is doesn't matter - so there is one
+        FFD_ENSURE(SByteOrder::Default == was,
+            "FFD: more than one [ByteOrder()] attribute")
+        return true;
+    });
+    // the machine types first: the enums are of them
+    _head->WalkForward ([&](SNode * n) {
+        if (! n->IsMachType ()) return true;
+        if (SByteOrder::Default == n->Order) n->Order = order;
+        n->Swap = n->Size > 1 && SByteOrder::Default != n->Order
+            && HOST != n->Order;
+        return true;
+    });
+    _head->WalkForward ([&](SNode * n) {
+        if (n->IsEnum () && n->DType)
+            n->Order = n->DType->Order, n->Swap = n->DType->Swap;
+        return true;
+    });
+    _head->WalkForward ([&](SNode * n) {
+        if (n->IsStruct ())
+            for (auto f : n->Fields)
+                n->Swap = n->Swap || (f->DType && f->DType->Swap);
+        return true;
+    });
+}// FFD::ResolveByteOrder()
+
+FFDNode * FFD::File2Tree(Stream & fh2, ParseContext & ctx) const
 {
     Stream * s {&fh2};
-    FFDNode * data_root {};
-    FFD_CREATE_OBJECT(data_root, FFDNode) {_root, s};
-    Dbg << "uncompressed stream s: " << s->Tell () << "/" << s->Size () << EOL;
+    FFD_ENSURE(nullptr == ctx.Map || s == ctx.Map,
+        "File2Tree: ParseContext::Map is another stream")
+    FFD_ENSURE(nullptr == ctx.Projection || ! ctx.Lazy,
+        "File2Tree: ParseContext::Projection with Lazy")
+    FFD_ENSURE(nullptr == ctx.Visitor || ! ctx.Lazy,
+        "File2Tree: ParseContext::Visitor with Lazy")
+    if (ctx.Projection) ctx.ProjectionAt (0) = FFDProjection::ROOT;
+    ctx.Memory = s->Memory ();
+    auto data_root = FFDNode::Create (ctx.Arena, _root, s, nullptr, nullptr,
+        _program, &ctx);
+    DbgD << "uncompressed stream s: " << s->Tell () << "/" << s->Size () << EOL;
     return data_root;
 }
-/*static*/ void FFD::FreeNode(FFDNode * n) { FFD_DESTROY_OBJECT(n, FFDNode) }
+
+FFDNode * FFD::File2Tree(Stream & fh2) const
+{
+    ParseContext ctx {*this};
+    return File2Tree (fh2, ctx);
+}
+
+// The fields named "name" of struct "st" - the ones of its composite fields
+// included. "vague": it has a variadic field - one of any struct.
+static void fields_named(FFD::SNode * st, const String & name,
+    List<FFD::SNode *> & result, bool & vague, int depth = 0)
+{
+    FFD_ENSURE(depth < 64, "FFD::CompilePath: composite struct recursion")
+    for (auto f : st->Fields)
+        if (f->Variadic) vague = true;
+        else if (f->Composite && f->DType && f->DType->IsStruct ())
+            fields_named (f->DType, name, result, vague, depth + 1);
+        else if (f->Name == name) result.Add (f);
+}
+
+FFD::Path FFD::CompilePath(const String & path) const
+{
+    Path result {};
+    result._names = &_names;
+    // the structs the step can be a field of; "any": can't tell
+    List<SNode *> at {};
+    at.Add (_root);
+    bool any {}, scalar {}, unindexed {};
+    String copy {path};
+    for (auto & s : copy.Split ('.')) {
+        String name {s};
+        Path::Step step {};
+        auto z = name.AsZStr ();
+        auto b = strchr (z, '[');
+        if (b) {
+            int i {1};
+            for (step.Index = 0; b[i] >= '0' && b[i] <= '9'; i++) {
+                FFD_ENSURE(step.Index < (1<<27), "FFD::CompilePath: index")
+                step.Index = 10 * step.Index + b[i] - '0';
+            }
+            FFD_ENSURE(i > 1 && ']' == b[i] && '\0' == b[i+1],
+                "FFD::CompilePath: \"name[n]\" it is")
+            name = String {reinterpret_cast<const byte *>(z),
+                static_cast<int>(b - z)};
+        }
+        FFD_ENSURE(! name.Empty (), "FFD::CompilePath: empty path step")
+        FFD_ENSURE(! scalar, "FFD::CompilePath: a step past a scalar")
+        FFD_ENSURE(! unindexed, "FFD::CompilePath: index the arrays on it")
+        step.NameId = _names.IndexOf (name);
+        FFD_ENSURE(step.NameId >= 0, "FFD::CompilePath: no such field")
+        if (any)
+            _head->WalkForward ([&](SNode * n) {
+                if (n->IsStruct ()) at.Add (n);
+                return true;
+            });
+        List<SNode *> found {};
+        any = false;
+        for (auto st : at) fields_named (st, name, found, any);
+        FFD_ENSURE(any || ! found.Empty (),
+            "FFD::CompilePath: no such field at the struct")
+        at = List<SNode *> {};
+        bool items {};
+        unindexed = step.Index < 0 && ! found.Empty ();
+        for (auto f : found) {
+            unindexed = unindexed && f->Array;
+            // parametrized: its fields are of the types it is given
+            if (nullptr == f->DType || f->Parametrized ()) any = true;
+            else if (f->DType->IsStruct ()) {
+                items = items || f->Array;
+                for (auto n : f->DType->NodesByName (f->DType->Name))
+                    if (n->IsStruct ()) at.Add (n);
+            }
+        }
+        FFD_ENSURE(step.Index < 0 || any || items,
+            "FFD::CompilePath: \"[n]\" of no array of structs")
+        scalar = ! any && at.Empty (), unindexed = unindexed && ! any;
+        result._steps.Add (step);
+    }
+    FFD_ENSURE(result.Steps () > 0, "FFD::CompilePath: empty path")
+    return result;
+}// FFD::CompilePath()
+
+void FFD::Compile()
+{
+    if (nullptr == _program) FFD_CREATE_OBJECT(_program, FFDProgram) {_head};
+}
+/*static*/ void FFD::FreeNode(FFDNode * n)
+{
+    if (n && n->InArena ()) return;
+    FFD_DESTROY_OBJECT(n, FFDNode)
+}
+/*static*/ void FFD::Free(FFD * n) { FFD_DESTROY_OBJECT(n, FFD) }
 #undef FFD_ENSURE_FFD
 
 NAMESPACE_FFD
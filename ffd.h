@@ -41,10 +41,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ffd_model.h"
 #include "ffd_parser.h"
 #include "ffd_dbg.h"
+#include "ffd_symbol_table.h"
 
 FFD_NAMESPACE
 
 class FFDNode;
+class FFDProgram;
+class FFDExpr;
+class FFDArena;
+class FFDMapStream;
+class FFDMemoryStream;
+class FFDProjection;
+class FFDVisitor;
 
 // File Format Description.
 // Wraps a ffd (a simple text file written using a simple grammar) that can be
@@ -55,6 +63,7 @@ class FFD_EXPORT FFD
 {
     public: FFD(const byte * buf, int len);
     public: ~FFD();
+    private: FFD() {} // see Load()
 
     // TODO FFD::Load ("description").Parse ("foo");
 
@@ -66,6 +75,11 @@ class FFD_EXPORT FFD
     public: enum class SType {Comment, MachType, TxtList, TxtTable, Unhandled,
         Struct, Field, Enum, Const, Format, Attribute};
     public: enum class SConstType {None, Int, Text};
+    // Default: the [ByteOrder(big|little)] attribute; the host one when there
+    // is none. The attribute is global: at most one, anywhere at the
+    // description, for all the types that don't name their own.
+    public: enum class SByteOrder {Default, Little, Big};
+    public: class ParseContext;
     public: class EnumItem final
     {
         public: EnumItem() {}
@@ -106,11 +120,85 @@ class FFD_EXPORT FFD
         }
 
         // Returns Usable() only! Means the SNode is enabled, and doesn't need
-        // evaluation.
-        public: SNode * NodeByName(const String &);
+        // evaluation. Without a ParseContext, Usable() means "has no Expr".
+        public: SNode * NodeByName(const String &,
+            const ParseContext * = nullptr);
         // Returns all that match the name, regardless of flags.
         public: List<SNode *> NodesByName(const String &);
 
+        // Set by the FFD for root-level nodes: their position at the
+        // description, and the index the lookups use instead of walking the
+        // entire LL. Field nodes don't have them: they look at their siblings.
+        public: int Ordinal {};
+        public: SymbolTable<SNode> * Symbols {};
+        // Adds it to Symbols, once. Parse() does so as soon as it is named:
+        // the "resolve: pass 1" lookups of its own fields find it then, as
+        // the walk of the LL did.
+        public: inline void Index()
+        {
+            if (Symbols && ! _indexed) Symbols->Add (this), _indexed = true;
+        }
+        private: bool _indexed {};
+        // Set by the FFD for all nodes: 0 ... n-1; the ParseContext keeps its
+        // per-input state by it.
+        public: int Id {};
+        // Set by the FFD for all nodes: the index of Name at Names - the same
+        // for all nodes named so; the FFDNode lookups compare it, not Name.
+        public: int NameId {-1};
+        public: const SymbolTable<SNode> * Names {};
+        // Set by the FFD for the nodes that have Fields: one slot per name at
+        // Fields; a FFDNode keeps its fields by slot. Field nodes: the slot of
+        // their name at Base.
+        public: int Slot {-1};
+        public: int SlotCount {};
+        // By NameId; -1: none of the Fields is named so.
+        public: inline int SlotOf(int name_id) const
+        {
+            if (name_id < 0 || _slots.Empty ()) return -1;
+            int const mask = _slots.Count () - 1;
+            for (int i = name_id & mask;; i = (i + 1) & mask)
+                if (_slots[i].NameId == name_id) return _slots[i].Slot;
+                else if (_slots[i].NameId < 0) return -1;
+        }
+        // Call once NameId is set for all Fields.
+        public: void NumberSlots();
+        private: struct SlotEntry final { int NameId {-1}; int Slot {-1}; };
+        private: List<SlotEntry> _slots {}; // power of 2; at least 1 free
+        // The one lookup rule: the nearest one, backwards (this included),
+        // accepted by "accept"; then the 1st one forward.
+        private: template <typename F> SNode * FindByName(const String & query,
+            F accept)
+        {
+            SNode * result {};
+            if (Symbols) {
+                auto list = Symbols->Find (query);
+                if (nullptr == list) return nullptr;
+                for (int i = list->Count () - 1; i >= 0 && ! result; i--)
+                    if ((*list)[i]->Ordinal <= Ordinal && accept ((*list)[i]))
+                        result = (*list)[i];
+                for (int i = 0; i < list->Count () && ! result; i++)
+                    if ((*list)[i]->Ordinal > Ordinal && accept ((*list)[i]))
+                        result = (*list)[i];
+                return result;
+            }
+            WalkBackwards([&](FFD::SNode * node) {
+                if (node->Name == query && accept (node)) {
+                    result = node;
+                    return false;
+                }
+                return true;
+            });
+            if (nullptr == result && Next)
+                Next->WalkForward([&](FFD::SNode * node) {
+                    if (node->Name == query && accept (node)) {
+                        result = node;
+                        return false;
+                    }
+                    return true;
+                });
+            return result;
+        }
+
         // Call after all nodes are parsed. Allows for dependency-independent
         // order of things at the description.
         public: void ResolveTypes();
@@ -129,6 +217,7 @@ class FFD_EXPORT FFD
         public: String DTypeName {}; // Prior resolve
         public: List<SNode *> Fields {};
         public: List<FFDParser::ExprToken> Expr {};
+        public: FFDExpr * CompiledExpr {}; // null: evaluate "Expr"
         public: String Comment {};
 
         public: bool HashKey {};
@@ -160,29 +249,8 @@ class FFD_EXPORT FFD
             }
             return false;
         }
-        public: inline SNode * FindVListItem(const String & dname, int value)
-        {//TODO this is the same as NodeByName, NodesByName, etc. unify them
-         //TODO more than one is an error: report it
-            FFD::SNode * result = {};
-            WalkBackwards([&](FFD::SNode * node) {
-                if (node->VListItem && node->Usable () && node->Name == dname
-                    && node->InValueList (value)) {
-                    result = node;
-                    return false;
-                }
-                return true;
-            });
-            if (nullptr == result && Next)
-                Next->WalkForward([&](FFD::SNode * node) {
-                    if (node->VListItem && node->Usable ()
-                        && node->Name == dname && node->InValueList (value)) {
-                        result = node;
-                        return false;
-                    }
-                    return true;
-                });
-            return result;
-        }
+        public: SNode * FindVListItem(const String & dname, int value,
+            const ParseContext * = nullptr);
 
         public: bool Composite {}; // replace it with FindDType (Name)
 
@@ -190,17 +258,19 @@ class FFD_EXPORT FFD
         public: String StringLiteral {};
         public: int IntLiteral {};
 
-        public: bool Enabled {}; // true when Expr has evaluated to it
-        public: bool Resolved {}; // true when Expr has been evaluated
-        public: bool inline Usable() const
-        {//TODO report ! Resolved
-            return Expr.Count () <= 0 || (Resolved && Enabled);
-        }
+        // No Expr, or the Expr has been evaluated to true at "ctx"; see
+        // ParseContext.
+        public: inline bool Usable(const ParseContext * ctx = nullptr) const;
 
         // Type == SType::MachType
         public: bool Signed {};
         public: int Size {};
         public: bool Fp {}; // floating point
+        // Type == SType::MachType, SType::Enum: the one of the file
+        public: SByteOrder Order {};
+        // Not the host one: the data are swapped to it as they're read. Set by
+        // the FFD; a struct has it when one of its fields does.
+        public: bool Swap {};
         // public SNode * Alias {};  // This could become useful later
 
         public: List<EnumItem> EnumItems {};
@@ -280,6 +350,14 @@ class FFD_EXPORT FFD
             };
         }
         public: inline bool HasExpr() const { return Expr.Count () > 0; }
+        // Hard-wired till the description can say so: this field, read as
+        // STOP_VALUE, stops parsing the input - see FFD::ParseContext::Skip.
+        // The compiled and the projected reads keep it, for FromField().
+        public: inline bool StopsParsing() const
+        {
+            return IsField () && "UVersion2" == Name;
+        }
+        public: static int constexpr STOP_VALUE {100};
         public: inline void DbgPrint()
         {
             Dbg << "+(" << Dbg.Fmt ("%p", this) << ")" << TypeToString ()
@@ -315,32 +393,39 @@ class FFD_EXPORT FFD
             }
         }
         // where there are no dynamic arrays and expressions
-        public: int PrecomputeSize()
+        public: int PrecomputeSize(const ParseContext * ctx = nullptr)
         {
             int result {};
             for (auto f : Fields) {
                 if (! f->DType) return 0;
                 if (! f->Expr.Empty ()) return 0;
                 if (f->DType->IsStruct ()) return 0;
-                if (f->Array) {
-                    int arr_result = 1, i {};
-                    for (; i < 3 && ! f->Arr[i].None (); i++) {
-                        if (! f->Arr[i].Name.Empty ()) {
-                            auto n = NodeByName (f->Arr[i].Name);
-                            if (n && ! n->IsIntConst ()) return 0;
-                            if (n) arr_result *= n->IntLiteral;
-                        }
-                        else
-                            arr_result *= f->Arr[i].Value;
-                    }
-                    FFD_ENSURE(i > 0, "array node w/o dimensions?")
-                    result += arr_result * f->DType->Size;
+                int count = f->FixedCount (ctx);
+                if (count <= 0) return 0;
+                result += count * f->DType->Size;
+            }
+            return result;
+        }// PrecomputeSize()
+        // Field: its items - 1 when it isn't an array; 0: a dimension isn't
+        // a const.
+        public: int FixedCount(const ParseContext * ctx = nullptr)
+        {
+            if (! Array) return 1;
+            int result = 1, i {};
+            for (; i < 3 && ! Arr[i].None (); i++) {
+                if (! Arr[i].Name.Empty ()) {
+                    // not a const: a field, likely - Base has no symbols
+                    // for those
+                    auto n = Base->NodeByName (Arr[i].Name, ctx);
+                    if (! n || ! n->IsIntConst ()) return 0;
+                    result *= n->IntLiteral;
                 }
                 else
-                    result += f->DType->Size;
+                    result *= Arr[i].Value;
             }
+            FFD_ENSURE(i > 0, "array node w/o dimensions?")
             return result;
-        }// PrecomputeSize()
+        }
         public: enum class PSType {Type, Field, IntLiteral};
         public: struct PSParam final
         {
@@ -416,35 +501,13 @@ class FFD_EXPORT FFD
                 if (f (PS[i])) return &(PS[i]);
             return nullptr;
         }
-        // Switching between input file version requires some invalidation.
-        // example: bool machine type differs in size based on input;
-        //          while caching it is ok, because bool is used at many places
-        //          within one input, caching across multiple inputs - isn't
-        //TODONT remove when the monolithic one is off
-        public: inline void Reset()
-        {
-            WalkForward ([](auto sn) { return sn->Invalidate (), true; });
-            WalkBackwards ([](auto sn) { return sn->Invalidate (), true; });
-        }
-        public: inline void Invalidate()
-        {
-            if (IsConst () || IsMachType () || IsEnum ()) {
-                Dbg << "Invalidate: " << Name << EOL;
-                Resolved = Enabled = false;
-            }
-            else if (IsStruct ()) {
-                // reset fields dtype - where said dtype is a machine type
-                // depending on an expression
-                for (auto f : Fields)
-                    f->DType = f->DType && f->DType->IsMachType ()
-                        && f->DType->HasExpr () ? nullptr : f->DType;
-            }
-        }
         // Simplify Helpers
-        private: int _uc{};
+        // Set once, by any of the threads parsing with this description.
+        private: bool _used {};
         public: inline void UseOnce()
         {
-            if (_uc < 0x7fffffff) _uc++;
+            if (__atomic_load_n (&_used, __ATOMIC_RELAXED)) return;
+            __atomic_store_n (&_used, true, __ATOMIC_RELAXED);
             // all unconditional fields become used
             if (this->IsStruct ())
                 for (auto n : this->Fields)
@@ -488,7 +551,7 @@ class FFD_EXPORT FFD
         }
         public: inline void PrintIfUsed()
         {//LATER to functions with a test-unit: parsed == generated
-            if (_uc <= 0) return;
+            if (! __atomic_load_n (&_used, __ATOMIC_RELAXED)) return;
             switch (Type) {
                 case FFD::SType::MachType:
                     Dbg << "type " << this->Name << " "; //TODO alias info
@@ -566,24 +629,207 @@ class FFD_EXPORT FFD
         }// PrintIfUsed()
     };// SNode
 
+    // Whatever parsing one input changes: File2Tree() doesn't modify the
+    // description, so one FFD can be shared by many threads - a ParseContext
+    // each. Reset() it between inputs; that is O(1).
+    //  - the Expr of "const", "type" and "enum" nodes: evaluated once per input
+    //  - field DType: resolved per input when it depends on an Expr; rewritten
+    //    per instance for parametrized structs
+    public: class ParseContext final
+    {
+        public: ParseContext(const FFD &);
+        public: inline void Reset()
+        {
+            Skip = false, Evaluating = String {};
+            if (! _huge.Empty ()) _huge = List<HugeArray> {};
+            if (_gen < ~0u) { _gen++; return; } // -fsanitize=integer: no wrap
+            for (int i = 0; i < _slots.Count (); i++) _slots[i].Gen = 0;
+            _gen = 1;
+        }
+        public: inline bool Resolved(const SNode * n) const
+        {
+            return Current (n) && _slots[n->Id].Resolved;
+        }
+        public: inline bool Enabled(const SNode * n) const
+        {
+            return Current (n) && _slots[n->Id].Enabled;
+        }
+        public: inline void Resolve(const SNode * n, bool enabled)
+        {
+            auto & s = Touch (n);
+            s.Resolved = true, s.Enabled = enabled;
+        }
+        // The DType of "n" at this input.
+        public: inline SNode * DType(const SNode * n) const
+        {
+            return Current (n) && _slots[n->Id].HasDType
+                ? _slots[n->Id].DType : n->DType;
+        }
+        public: inline void SetDType(const SNode * n, SNode * dtype)
+        {
+            auto & s = Touch (n);
+            s.HasDType = true, s.DType = dtype;
+        }
+        // The symbol whose Expr is being evaluated: see ResolveSNode().
+        public: String Evaluating {};
+        // Stop parsing this input: see SNode::StopsParsing().
+        public: bool Skip {};
+        // Null: the tree is allocated node by node, FreeNode() frees it.
+        // Otherwise it is allocated from there; FreeNode() does nothing and
+        // the tree is valid until FFDArena::Reset(). Reset() doesn't touch it.
+        public: FFDArena * Arena {};
+        // Null: the data of the nodes are copied from the stream. Otherwise
+        // it is the stream given to File2Tree() and the data are views into
+        // its mapping, valid while it is. Reset() doesn't touch it.
+        public: FFDMapStream * Map {};
+        // Set by File2Tree(): Stream::Memory() of its stream. Non-null: the
+        // nodes read it inline.
+        public: FFDMemoryStream * Memory {};
+        // With Compile(): the fixed-layout structs and the fixed-size arrays
+        // are skipped, and read when the tree asks for them - Nodes(),
+        // NodeByName(), AsInt(), ... Then the stream and this one must
+        // outlive the tree, and not be used for another input meanwhile.
+        // Not thread-safe: one thread reads a lazy tree.
+        public: bool Lazy {};
+        // Null: the whole tree is built. Otherwise just its paths, and what
+        // they depend on; see FFDProjection. Not with Lazy. Reset() doesn't
+        // touch it.
+        public: const FFDProjection * Projection {};
+        // Projection: the state of the node being built at "level"; see
+        // FFDProjection::Child().
+        public: inline int & ProjectionAt(int level)
+        {
+            while (_projection.Count () <= level) _projection.Add (0);
+            return _projection[level];
+        }
+        // Non-null: the fields are passed to it as they're parsed; see
+        // FFDVisitor. Not with Lazy. Reset() doesn't touch it.
+        public: FFDVisitor * Visitor {};
+        // "n" bytes, until the next call: the data no FFDNode is made for -
+        // see Visitor - and read-until arrays.
+        public: inline byte * Scratch(int n)
+        {
+            if (_scratch.Length () < n) _scratch.Resize (n);
+            return _scratch.operator byte * ();
+        }
+        // 0: File2Tree() fails on the arrays larger than the "suspicious
+        // array size" limits. Otherwise the ones of machine types, enums and
+        // fixed-size structs, of up to this many bytes - and no more than
+        // the stream has left - are left at the stream: see FFDArrayCursor.
+        // Then the stream and this one must outlive the tree, and not be
+        // used for another input meanwhile. Reset() doesn't touch it.
+        public: long long HugeArrays {};
+        // HugeArrays: where one is, at the stream. Not at the FFDNode: an
+        // off_t and a long long more in every node of every tree, for the
+        // few huge ones. Their FFDNode::_at is the index here instead.
+        public: struct HugeArray final
+        {
+            off_t At;
+            long long Bytes;
+        };
+        public: inline int AddHuge(off_t at, long long bytes)
+        {
+            return _huge.Add (HugeArray {at, bytes}), _huge.Count () - 1;
+        }
+        public: inline const HugeArray & Huge(int i) const { return _huge[i]; }
+        private: struct Slot final
+        {
+            unsigned int Gen {}; // valid when == _gen
+            bool Resolved {}, Enabled {}, HasDType {};
+            SNode * DType {};
+        };
+        private: List<Slot> _slots {}; // by SNode::Id
+        private: unsigned int _gen {1};
+        private: List<int> _projection {}; // by level
+        private: ByteArray _scratch {};
+        private: List<HugeArray> _huge {}; // this input's
+        private: inline bool Current(const SNode * n) const
+        {
+            return _slots[n->Id].Gen == _gen;
+        }
+        private: inline Slot & Touch(const SNode * n)
+        {
+            auto & s = _slots[n->Id];
+            if (s.Gen != _gen) s = Slot {}, s.Gen = _gen;
+            return s;
+        }
+    };// ParseContext
+
+    // A field path, checked against the description and resolved to name ids
+    // once: see CompilePath(), FFDNode::NodeByPath(). Valid for the trees of
+    // the FFD that made it; read-only - one can be shared by many threads.
+    public: class Path final
+    {
+        public: inline int Steps() const { return _steps.Count (); }
+        private: friend class FFD;
+        private: friend class FFDNode;
+        private: struct Step final
+        {
+            int NameId {-1}; // see SNode::NameId
+            int Index {-1};  // "name[Index]"; -1: none
+        };
+        private: List<Step> _steps {};
+        private: const SymbolTable<SNode> * _names {}; // of the FFD
+    };// Path
+
     private: SNode * _root {};
+    private: SymbolTable<SNode> _symbols {}; // root-level nodes, by Name
+    private: SymbolTable<SNode> _names {}; // all nodes; see SNode::NameId
     // An LL is preferable to a list, because each node should be able to look
     // at its neighbors w/o accessing third party objects.
     private: FFD::SNode * _tail {}, * _head {}; // DLL<FFD::SNode>
-
-    public: FFDNode * File2Tree(Stream &);
+    private: FFDProgram * _program {};
+    private: int _node_count {}; // see SNode::Id
+    private: void NumberNodes();
+    private: void CompileExpressions();
+    // Sets SNode::Order - the ones left to the attribute - and SNode::Swap.
+    // More than one attribute: it fails; see SByteOrder.
+    private: void ResolveByteOrder();
+    // of the text the description was parsed from; see Load()
+    private: int _text_len {};
+    private: unsigned int _text_checksum {};
+    private: static unsigned int Checksum(const byte *, int);
+
+    // "ctx": one per thread; see ParseContext. The one without it uses a new
+    // ParseContext per call.
+    public: FFDNode * File2Tree(Stream &, ParseContext & ctx) const;
+    public: FFDNode * File2Tree(Stream &) const;
+    // "path": field names from the root, separated by "."; an array of
+    // structs is indexed: "Header.Blocks[2].Size". It fails when the
+    // description has no such path - where it can tell: a variadic field
+    // can be of many structs.
+    public: Path CompilePath(const String & path) const;
+    // A binary image of the description: Load() doesn't parse text. Save()
+    // any time: parsing keeps its state at the ParseContext, not here.
+    public: void Save(Stream &) const;
+    // Returns null when "image" isn't one Save() made out of "text": stale,
+    // of another version, or damaged. "image" isn't referenced afterwards -
+    // a mapped file is fine. Free with Free().
+    public: static FFD * Load(const byte * image, int len, const byte * text,
+        int text_len);
+    // Lower the description to a program of decode ops (see FFDProgram);
+    // File2Tree() runs it from then on. Optional; the result is the same tree.
+    // Not thread-safe: call it prior sharing the FFD.
+    public: void Compile();
     // free the memory used by the parameter
     public: static void FreeNode(FFDNode *);
+    // free the memory used by the result of Load()
+    public: static void Free(FFD *);
     // get root-level attribute (temporary - until attributes get assigned to
     // their respective nodes)
     public: inline SNode * GetAttr(const String & query) const
     {
         return _root->GetAttr (query);
     }
-    public: inline void Invalidate() { _root->Reset ();}
     public: inline SNode * Head() const { return _head; }
 };// FFD
 
+inline bool FFD::SNode::Usable(const ParseContext * ctx) const
+{//TODO report ! Resolved
+    return Expr.Count () <= 0 || (ctx && ctx->Resolved (this)
+        && ctx->Enabled (this));
+}
+
 NAMESPACE_FFD
 
 #endif
\ No newline at end of file
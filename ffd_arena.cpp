@@ -0,0 +1,150 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_arena.h"
+
+FFD_NAMESPACE
+
+static size_t constexpr FFD_ARENA_ALIGN {16};
+static inline size_t arena_align(size_t n)
+{
+    return (n + FFD_ARENA_ALIGN - 1) & ~(FFD_ARENA_ALIGN - 1);
+}
+
+struct alignas(FFD_ARENA_ALIGN) FFDArena::Block final
+{
+    Block * Prev;
+    size_t Size; // the bytes past this header
+};
+
+struct FFDArena::Cleanup final
+{
+    void (*Fn)(void *);
+    void * Arg;
+    Cleanup * Next;
+};
+
+FFDArena::FFDArena(size_t block_size)
+    : _block_size {arena_align (block_size > 0 ? block_size : 1)}
+{
+}
+
+FFDArena::~FFDArena()
+{
+    Reset ();
+    FreeBlocks ();
+}
+
+void FFDArena::NewBlock(size_t size)
+{
+    size = arena_align (size);
+    byte * p {};
+    OS::Alloc (p, sizeof(Block) + size);
+    auto b = reinterpret_cast<Block *>(p);
+    b->Prev = _block, b->Size = size;
+    _block = b;
+    _top = p + sizeof(Block), _end = _top + size;
+    _reserved += size;
+}
+
+void FFDArena::FreeBlocks()
+{
+    while (_block) {
+        auto p = reinterpret_cast<byte *>(_block);
+        _block = _block->Prev;
+        OS::Free (p);
+    }
+    _top = _end = nullptr, _reserved = 0;
+}
+
+void * FFDArena::Alloc(size_t n)
+{
+    n = arena_align (n > 0 ? n : 1);
+    if (static_cast<size_t>(_end - _top) < n)
+        NewBlock (n > _block_size ? n : _block_size);
+    auto p = _top;
+    _top += n, _used += n;
+    if (_used > _peak) _peak = _used;
+    return p;
+}
+
+void * FFDArena::Grow(void * p, size_t size, size_t new_size)
+{
+    if (nullptr == p) return Alloc (new_size);
+    auto b = static_cast<byte *>(p);
+    size = arena_align (size), new_size = arena_align (new_size);
+    if (new_size <= size) return p;
+    if (b + size == _top && static_cast<size_t>(_end - b) >= new_size) {
+        _top = b + new_size, _used += new_size - size;
+        if (_used > _peak) _peak = _used;
+        return p;
+    }
+    auto q = Alloc (new_size);
+    OS::Memcpy (q, p, size);
+    return q;
+}
+
+void FFDArena::AtReset(void (*fn)(void *), void * arg)
+{
+    auto c = static_cast<Cleanup *>(Alloc (sizeof(Cleanup)));
+    c->Fn = fn, c->Arg = arg, c->Next = _cleanup;
+    _cleanup = c;
+}
+
+bool FFDArena::Owns(const void * p) const
+{
+    auto q = static_cast<const byte *>(p);
+    for (auto b = _block; b; b = b->Prev) {
+        auto top = reinterpret_cast<const byte *>(b) + sizeof(Block);
+        if (q >= top && q < top + b->Size) return true;
+    }
+    return false;
+}
+
+void FFDArena::Reset()
+{
+    for (auto c = _cleanup; c; c = c->Next) c->Fn (c->Arg);
+    _cleanup = nullptr;
+    _used = 0;
+    if (! _block) return;
+    if (_block->Prev) { // spilled: one block for all of it, next time
+        auto size = _reserved;
+        FreeBlocks ();
+        NewBlock (size);
+        return;
+    }
+    _top = reinterpret_cast<byte *>(_block) + sizeof(Block);
+}
+
+NAMESPACE_FFD
@@ -0,0 +1,148 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// A bump allocator for the trees File2Tree() builds; see
+// FFD::ParseContext::Arena. Nothing is freed piecemeal: Reset() frees it
+// all at once.
+
+#ifndef _FFD_ARENA_H_
+#define _FFD_ARENA_H_
+
+#include "ffd_model.h"
+
+FFD_NAMESPACE
+
+class FFD_EXPORT FFDArena final
+{
+    // "block_size": the usual one; larger requests get a block of their own.
+    public: FFDArena(size_t block_size = 1<<20);
+    public: ~FFDArena();
+    public: FFDArena(const FFDArena &) = delete;
+    public: FFDArena & operator=(const FFDArena &) = delete;
+
+    // 16-byte aligned; not zeroed.
+    public: void * Alloc(size_t);
+    // "p" of "size" bytes, now "new_size" ones. In place when "p" is the
+    // last Alloc() and there is room; copied otherwise. "p" can be null.
+    public: void * Grow(void * p, size_t size, size_t new_size);
+    // All that was allocated is gone: AtReset() callbacks are called, in
+    // reverse order, and one block is kept - large enough for the peak.
+    public: void Reset();
+    // For the things holding memory elsewhere.
+    public: void AtReset(void (*)(void *), void *);
+    // "p" is at one of its blocks: Alloc() made it - not the stack.
+    public: bool Owns(const void * p) const;
+
+    // [bytes]
+    public: inline size_t Used() const { return _used; }
+    public: inline size_t Peak() const { return _peak; }
+    public: inline size_t Reserved() const { return _reserved; }
+
+    private: struct Block;
+    private: struct Cleanup;
+    private: Block * _block {}; // the current one; the previous ones: ->Prev
+    private: byte * _top {}, * _end {};
+    private: size_t _block_size, _used {}, _peak {}, _reserved {};
+    private: Cleanup * _cleanup {};
+    private: void NewBlock(size_t);
+    private: void FreeBlocks();
+};// FFDArena
+
+// The List<T> and ByteArray subset an FFDNode needs: from an FFDArena when
+// there is one, from the heap otherwise. T: no constructor, no destructor.
+// Or a View() of memory it doesn't own; changing it makes a copy first.
+template <typename T> class ArenaArray final
+{
+    public: ArenaArray() {}
+    public: ~ArenaArray() { if (! _arena && _cap >= 0) OS::Free (_p); }
+    public: ArenaArray(const ArenaArray &) = delete;
+    public: ArenaArray & operator=(const ArenaArray &) = delete;
+    // Prior the 1st Add() or Resize().
+    public: inline void Use(FFDArena * a) { _arena = a; }
+    // Prior the 1st Add() or Resize(): "n" items at "p", which outlive it.
+    public: inline void View(const T * p, int n)
+    {
+        FFD_ENSURE(nullptr == _p, "ArenaArray: View() of a used one")
+        _p = const_cast<T *>(p), _n = n, _cap = -1;
+    }
+    public: inline bool IsView() const { return _cap < 0; }
+    // A View(): copies it; it can be changed in place then.
+    public: inline void Own() { if (_cap < 0 && _n > 0) Reserve (_n); }
+
+    public: inline int Count() const { return _n; }
+    public: inline int Length() const { return _n; }
+    public: inline bool Empty() const { return _n <= 0; }
+    public: inline const T * begin() const { return _p; }
+    public: inline const T * end  () const { return _p + _n; }
+    public: inline T & operator[](int i) { return _p[i]; }
+    public: inline const T & operator[](int i) const { return _p[i]; }
+    public: inline operator T * () const { return _p; }
+    public: inline T & Add(const T & v)
+    {
+        if (_n >= _cap) Reserve (_n > 0 ? 2 * _n : 4);
+        return _p[_n++] = v;
+    }
+    // New items are zeroed.
+    public: inline void Resize(int n)
+    {
+        FFD_ENSURE(n >= 0, "ArenaArray: negative size")
+        if (n > (_cap < 0 ? _n : _cap)) Reserve (n);
+        if (n > _n) memset (_p + _n, 0, (n - _n) * sizeof(T));
+        _n = n;
+    }
+
+    private: T * _p {};
+    private: int _n {}, _cap {}; // _cap < 0: a View()
+    private: FFDArena * _arena {};
+    private: inline void Reserve(int cap)
+    {
+        if (_cap < 0) { // copy it, then it is as any other one
+            auto p = _p;
+            _p = nullptr, _cap = 0;
+            Reserve (cap);
+            if (_n > 0) memcpy (_p, p, _n * sizeof(T));
+            return;
+        }
+        if (_arena)
+            _p = static_cast<T *>(_arena->Grow (_p, _cap * sizeof(T),
+                cap * sizeof(T)));
+        else
+            OS::Realloc (_p, cap);
+        _cap = cap;
+    }
+};// ArenaArray
+
+NAMESPACE_FFD
+
+#endif
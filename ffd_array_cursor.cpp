@@ -0,0 +1,84 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_array_cursor.h"
+#include "ffd_node.h"
+#include "ffd_memory_stream.h"
+
+FFD_NAMESPACE
+
+FFDArrayCursor::FFDArrayCursor(FFDNode * array, int chunk)
+    : _node {array}, _chunk {chunk}
+{
+    FFD_ENSURE(array && array->_array && array->_array_item_size > 0,
+        "FFDArrayCursor: not an array of fixed-size items")
+    _size = array->_array_item_size;
+    FFD_ENSURE(chunk > 0 && chunk <= (1<<30) / _size,
+        "FFDArrayCursor: chunk out of range")
+    if (array->IsHuge ()) {
+        auto & h = array->_ctx->Huge (array->_at);
+        _at = h.At, _total = h.Bytes / _size;
+    }
+    else _total = array->NodeCount ();
+}
+
+bool FFDArrayCursor::Next()
+{
+    _index += _count, _count = 0, _p = nullptr;
+    if (_index >= _total) return false;
+    _count = _total - _index < _chunk
+        ? static_cast<int>(_total - _index) : _chunk;
+    if (_at < 0) {
+        _p = _node->_data.operator byte * () + _index * _size;
+        return true;
+    }
+    Stream & s = *(_node->_s);
+    off_t at = _at + _index * _size;
+    auto m = s.Memory ();
+    auto dt = _node->_dt;
+    bool swap = dt && dt->Swap;
+    if (m && ! swap) return _p = m->Data () + at, true;
+    int n = _count * _size;
+    if (_buf.Length () < n) _buf.Resize (n);
+    if (m) OS::Memcpy (_buf.operator byte * (), m->Data () + at, n);
+    else {
+        auto back = s.Tell ();
+        s.Seek (at - back).Read (_buf.operator byte * (), n);
+        s.Seek (back - s.Tell ());
+    }
+    if (swap) FFDNode::ToHostOrder (dt, _buf, n, _node->_ctx);
+    return _p = _buf.operator byte * (), true;
+}
+
+NAMESPACE_FFD
@@ -0,0 +1,89 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// The items of an array, a chunk at a time: for the ones too large to be read
+// - see FFD::ParseContext::HugeArrays - and for any other of fixed-size items.
+
+#ifndef _FFD_ARRAY_CURSOR_H_
+#define _FFD_ARRAY_CURSOR_H_
+
+#include "ffd_model.h"
+
+FFD_NAMESPACE
+
+class FFDNode;
+
+// Usage:
+//   FFD::ParseContext ctx {ffd};
+//   ctx.HugeArrays = 1ll<<34;
+//   auto tree = ffd.File2Tree (s, ctx);
+//   FFDArrayCursor c {tree->NodeByName ("Points")};
+//   while (c.Next ())
+//       for (int i = 0; i < c.Count (); i++) use (c.As<float> ()[i]);
+// A huge array is read from the stream chunk by chunk - one buffer of
+// "chunk" items - or viewed in place when the stream is an FFDMemoryStream
+// and the items are in the host byte order; see FFD::SNode::Swap.
+// It moves the stream: not while another one is being read from it.
+class FFD_EXPORT FFDArrayCursor final
+{
+    // "array": of machine types, enums or fixed-size structs - not
+    // ArrayOfFields(); "chunk": items per Next(), at most.
+    public: FFDArrayCursor(FFDNode * array, int chunk = 1<<16);
+    public: ~FFDArrayCursor() {}
+    public: FFDArrayCursor(const FFDArrayCursor &) = delete;
+    public: FFDArrayCursor & operator=(const FFDArrayCursor &) = delete;
+
+    // The next chunk; false: there is none.
+    public: bool Next();
+    public: inline const byte * Data() const { return _p; }
+    public: template <typename T> inline const T * As() const
+    {
+        return reinterpret_cast<const T *>(_p);
+    }
+    public: inline int Count() const { return _count; } // items at Data()
+    public: inline long long Index() const { return _index; } // of Data()
+    public: inline long long Total() const { return _total; } // items
+    public: inline int ItemSize() const { return _size; } // [bytes]
+
+    private: FFDNode * _node;
+    private: int _size {}, _chunk {}, _count {};
+    private: long long _index {}, _total {};
+    private: off_t _at {-1}; // of a huge one, at the stream; -1: at _data
+    private: ByteArray _buf {};
+    private: const byte * _p {};
+};// FFDArrayCursor
+
+NAMESPACE_FFD
+
+#endif
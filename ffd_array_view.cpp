@@ -0,0 +1,84 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_array_view.h"
+#include "ffd_node.h"
+
+FFD_NAMESPACE
+
+FFDArrayView::FFDArrayView(FFDNode * array)
+{
+    FFD_ENSURE(array && array->_array, "FFDArrayView: not an array")
+    FFD_ENSURE(! array->IsHuge (), "FFDArrayView: a huge one - see "
+        "FFDArrayCursor")
+    int count = array->NodeCount ();
+    _size = array->_array_item_size;
+    auto dt = array->_dt;
+    if (0 == _size && dt && (dt->IsMachType () || dt->IsEnum ()))
+        _size = dt->Size, count = array->_data.Length () / _size; // [-key]
+    _p = array->_data.operator byte * ();
+    _dims = array->FieldNode ()->ArrDims ();
+    FFD_ENSURE(_dims > 0, "FFDArrayView: an array of no dimensions")
+    for (int d = _dims - 1, s = 1; d >= 0; s *= _extent[d--])
+        _extent[d] = array->_arr_dim[d], _stride[d] = s;
+    FFD_ENSURE(Count () == count, "FFDArrayView: the dimensions aren't "
+        "the items: a jagged one")
+}
+
+FFDArrayView FFDArrayView::Sub(int i) const
+{
+    FFD_ENSURE(_dims > 1, "FFDArrayView: Sub() of one dimension; Index() it")
+    FFD_ENSURE(i >= 0 && i < _extent[0], "FFDArrayView: Sub() out of range")
+    FFDArrayView result {*this};
+    result._at += i * _stride[0], result._dims--;
+    for (int d = 0; d < result._dims; d++)
+        result._extent[d] = _extent[d + 1], result._stride[d] = _stride[d + 1];
+    result._extent[result._dims] = result._stride[result._dims] = 0;
+    return result;
+}
+
+FFDArrayView FFDArrayView::Slice(int dim, int from, int count, int step)
+    const
+{
+    FFD_ENSURE(dim >= 0 && dim < _dims, "FFDArrayView: no such dimension")
+    FFD_ENSURE(step > 0 && count >= 0 && from >= 0
+        && (0 == count || from + (count - 1) * step < _extent[dim]),
+        "FFDArrayView: Slice() out of range")
+    FFDArrayView result {*this};
+    result._at += from * _stride[dim];
+    result._extent[dim] = count, result._stride[dim] *= step;
+    return result;
+}
+
+NAMESPACE_FFD
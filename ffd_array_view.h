@@ -0,0 +1,123 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// The items of an array by their position at each of its dimensions.
+
+#ifndef _FFD_ARRAY_VIEW_H_
+#define _FFD_ARRAY_VIEW_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+FFD_NAMESPACE
+
+class FFDNode;
+
+// Usage - "Tiles": "TTile Tiles[L][H][W]", fixed-size; see FFDStructArray:
+//   FFDArrayView map {tree->NodeByName ("Tiles")};
+//   FFDStructArray tiles {tree->NodeByName ("Tiles")};
+//   int terrain = tiles.IndexOf ("Terrain");
+//   auto level = map.Sub (1);           // a plane: [H][W]
+//   auto column = level.Slice (1, 5, 1); // [H][1]: x == 5
+//   column.ForEach ([&](int i) { use (tiles.AsInt (i, terrain)); });
+// Row-major: the last dimension is the one whose items are next to each
+// other. An index - Index(), ForEach() - is the one of the item at the
+// array: Item() of its data, or (*array)[index] when ArrayOfFields().
+// Valid while the array node is. Not range-checked: Index(), Item().
+class FFD_EXPORT FFDArrayView final
+{
+    // "array": not IsHuge() - see FFDArrayCursor for those.
+    public: FFDArrayView(FFDNode * array);
+    public: ~FFDArrayView() {}
+
+    public: inline int Dims() const { return _dims; }
+    public: inline int Extent(int dim) const { return _extent[dim]; }
+    public: inline int Count() const // items
+    {
+        int result {1};
+        for (int i = 0; i < _dims; i++) result *= _extent[i];
+        return result;
+    }
+    // [bytes]; 0: ArrayOfFields() - the items are FFDNode-s
+    public: inline int ItemSize() const { return _size; }
+
+    public: inline int Index(int i) const { return _at + i * _stride[0]; }
+    public: inline int Index(int i, int j) const
+    {
+        return _at + i * _stride[0] + j * _stride[1];
+    }
+    public: inline int Index(int i, int j, int k) const
+    {
+        return _at + i * _stride[0] + j * _stride[1] + k * _stride[2];
+    }
+    public: inline const byte * Item(int index) const
+    {
+        return _p + static_cast<long>(index) * _size;
+    }
+    public: template <typename T> inline T As(int index) const
+    {
+        T result;
+        return OS::Memcpy (&result, Item (index), sizeof (T)), result;
+    }
+
+    // [i]: one dimension less - a plane of a 3 dimensional one, a row of a
+    // 2 dimensional one.
+    public: FFDArrayView Sub(int i) const;
+    // "count" items of dimension "dim", from "from", each "step"-th one.
+    public: FFDArrayView Slice(int dim, int from, int count, int step = 1)
+        const;
+
+    // on_item (index), in row-major order
+    public: template <typename F> void ForEach(F on_item) const
+    {
+        static_assert(3 == FFD_MAX_ARR_DIMS, "FFDArrayView: 3 loops");
+        // as 3 dimensions: the missing outer ones have 1 item
+        int e[3] {1, 1, 1}, s[3] {};
+        for (int d = 0; d < _dims; d++)
+            e[3 - _dims + d] = _extent[d], s[3 - _dims + d] = _stride[d];
+        for (int i = 0, a = _at; i < e[0]; i++, a += s[0])
+            for (int j = 0, b = a; j < e[1]; j++, b += s[1])
+                for (int k = 0, c = b; k < e[2]; k++, c += s[2])
+                    on_item (c);
+    }
+
+    private: const byte * _p {};
+    private: int _size {}, _dims {}, _at {};
+    private: int _extent[FFD_MAX_ARR_DIMS] {};
+    private: int _stride[FFD_MAX_ARR_DIMS] {}; // [items]
+};// FFDArrayView
+
+NAMESPACE_FFD
+
+#endif
@@ -0,0 +1,291 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_corpus.h"
+#include "ffd_node.h"
+#include "ffd_arena.h"
+#include "ffd_prefetch.h"
+
+#include <new>
+#include <strings.h>
+
+FFD_NAMESPACE
+
+// One tree at a time: an ordered Run() can have a worker some files ahead of
+// the one reported - each of their trees keeps its arena until it is.
+struct FFDCorpus::Slot final
+{
+    // small blocks: after a Reset() it keeps one the size of the last tree
+    FFDArena Arena {1<<16};
+    int Held {}; // its tree is waiting to be reported
+};// FFDCorpus::Slot
+
+struct FFDCorpus::Worker final
+{
+    Worker(FFDCorpus & c, int id) : Corpus {c}, Id {id}, Ctx {c._ffd}
+    {
+        pthread_mutex_init (&Lock, nullptr);
+    }
+    ~Worker()
+    {
+        FFD_DESTROY_OBJECT(Ahead, FFDPrefetch)
+        for (int i = 0; i < Arenas.Count (); i++)
+            FFD_DESTROY_OBJECT(Arenas[i], Slot)
+        pthread_mutex_destroy (&Lock);
+    }
+    // The first one not held, reset; a new one when all of them are.
+    Slot * Free()
+    {
+        for (int i = 0; i < Arenas.Count (); i++)
+            if (! __atomic_load_n (&(Arenas[i]->Held), __ATOMIC_ACQUIRE)) {
+                Arenas[i]->Arena.Reset ();
+                return Arenas[i];
+            }
+        Slot * a {};
+        FFD_CREATE_OBJECT(a, Slot) {};
+        return Arenas.Add (a);
+    }
+    FFDCorpus & Corpus;
+    int Id;
+    FFD::ParseContext Ctx;
+    // The trees; as many as there are waiting to be reported, at most.
+    List<Slot *> Arenas {};
+    pthread_t Thread {};
+    pthread_mutex_t Lock;
+    List<int> Jobs {}; // indices at _files; the ones at [Head, Tail) are left
+    int Head {}, Tail {};
+    FFDPrefetch * Ahead {}; // FFDCorpus::Prefetch(); tags: the jobs
+};// FFDCorpus::Worker
+
+Stream * FFDCorpus::Client::Opened(int, const char *, FFDMemoryStream & data)
+{
+    return &data;
+}
+
+FFDCorpus::FFDCorpus(const FFD & ffd, int workers)
+    : _ffd {ffd}
+{
+    if (workers <= 0)
+        workers = static_cast<int>(sysconf (_SC_NPROCESSORS_ONLN));
+    if (workers <= 0) workers = 1;
+    for (int i = 0; i < workers; i++) {
+        Worker * w {};
+        FFD_CREATE_OBJECT(w, Worker) {*this, i};
+        _workers.Add (w);
+    }
+    pthread_mutex_init (&_order_lock, nullptr);
+}
+
+FFDCorpus::~FFDCorpus()
+{
+    for (int i = 0; i < _workers.Count (); i++)
+        FFD_DESTROY_OBJECT(_workers[i], Worker)
+    pthread_mutex_destroy (&_order_lock);
+}
+
+void FFDCorpus::Add(const char * file_name)
+{
+    FFD_ENSURE(nullptr != file_name, "FFDCorpus: null file name")
+    _files.Add (String {file_name});
+}
+
+// The extension of "n" is one of "a,b,c", case-insensitive.
+static bool ext_match(const char * n, const char * ext_list)
+{
+    auto dot = strrchr (n, '.');
+    if (nullptr == dot || ! dot[1]) return false;
+    auto ext = dot + 1;
+    auto len = OS::Strlen (ext);
+    for (auto e = ext_list; *e;) {
+        auto end = strchr (e, ',');
+        size_t elen = end ? static_cast<size_t>(end - e) : OS::Strlen (e);
+        if (elen == len && 0 == strncasecmp (e, ext, len)) return true;
+        if (! end) break;
+        e = end + 1;
+    }
+    return false;
+}
+
+int FFDCorpus::AddDirectory(const char * path, const char * ext_list)
+{
+    FFD_ENSURE(nullptr != ext_list, "FFDCorpus: null extension list")
+    int count {};
+    auto plen = OS::Strlen (path);
+    OS::EnumFiles (path, [&](const char * n, bool directory) {
+        auto nlen = OS::Strlen (n);
+        char * fp {};
+        OS::Alloc (fp, plen + 1 + nlen + 1);
+        OS::__pointless_verbosity::__try_finally_free<char> _ {fp};
+        OS::Memcpy (fp, path, plen);
+        fp[plen] = FFD_PATH_SEPARATOR;
+        OS::Memcpy (fp + plen + 1, n, nlen);
+        if (directory) count += AddDirectory (fp, ext_list);
+        else if (ext_match (n, ext_list)) Add (fp), count++;
+        return true;
+    });
+    return count;
+}
+
+// Own jobs: lowest index first. Someone else's: their highest one.
+int FFDCorpus::Take(Worker & w)
+{
+    int job {-1};
+    pthread_mutex_lock (&w.Lock);
+    if (w.Head < w.Tail) job = w.Jobs[w.Head++];
+    pthread_mutex_unlock (&w.Lock);
+    for (int i = 1; job < 0 && i < _workers.Count (); i++) {
+        auto & v = *(_workers[(w.Id + i) % _workers.Count ()]);
+        pthread_mutex_lock (&v.Lock);
+        if (v.Head < v.Tail) job = v.Jobs[--v.Tail];
+        pthread_mutex_unlock (&v.Lock);
+    }
+    return job;
+}
+
+void FFDCorpus::Release(const Result & r, Slot * a)
+{
+    if (r.Tree) FFD::FreeNode (r.Tree);
+    if (a) __atomic_store_n (&(a->Held), 0, __ATOMIC_RELEASE);
+}
+
+void FFDCorpus::Report(const Result & r, Slot * a)
+{
+    if (! _ordered) {
+        _client->Parsed (r);
+        Release (r, a);
+        return;
+    }
+    pthread_mutex_lock (&_order_lock);
+    auto & p = _pending[r.Index];
+    p.R = r, p.Held = a, p.Done = true;
+    if (_draining) { pthread_mutex_unlock (&_order_lock); return; }
+    _draining = true;
+    while (_next < _pending.Count () && _pending[_next].Done) {
+        auto next = _pending[_next].R;
+        auto held = _pending[_next++].Held;
+        pthread_mutex_unlock (&_order_lock);
+        _client->Parsed (next);
+        Release (next, held);
+        pthread_mutex_lock (&_order_lock);
+    }
+    _draining = false;
+    pthread_mutex_unlock (&_order_lock);
+}
+
+void FFDCorpus::Parse(Worker & w, int job, Stream * s)
+{
+    Result r {};
+    r.Index = job, r.FileName = _files[job].AsZStr (), r.Worker = w.Id;
+    Slot * a {};
+    if (s) {
+        a = w.Free ();
+        a->Held = 1;
+        w.Ctx.Reset ();
+        w.Ctx.Arena = &(a->Arena);
+        r.Tree = _ffd.File2Tree (*s, w.Ctx);
+        r.Skipped = w.Ctx.Skip;
+        r.Unread = s->Size () - s->Tell ();
+    }
+    Report (r, a);
+}
+
+/*static*/ void * FFDCorpus::Work(void * p)
+{
+    auto & w = *static_cast<Worker *>(p);
+    auto & c = w.Corpus;
+    if (! w.Ahead) {
+        for (int job; (job = c.Take (w)) >= 0;)
+            c.Parse (w, job, c._client->Open (w.Id, c._files[job].AsZStr ()));
+        return nullptr;
+    }
+    // the jobs it takes are read while the one before them is parsed
+    auto & a = *(w.Ahead);
+    for (;;) {
+        for (int job; a.Count () < a.Depth () && (job = c.Take (w)) >= 0;)
+            a.Add (c._files[job].AsZStr (), job);
+        if (0 == a.Count ()) break;
+        auto data = a.Next ();
+        int job = a.Tag ();
+        c.Parse (w, job, data ? c._client->Opened (w.Id,
+            c._files[job].AsZStr (), *data) : nullptr);
+    }
+    return nullptr;
+}
+
+void FFDCorpus::Run(Client & client, bool ordered)
+{
+    _client = &client, _ordered = ordered, _next = 0, _draining = false;
+    _pending = List<Pending> {};
+    if (ordered)
+        for (int i = 0; i < _files.Count (); i++) _pending.Add (Pending {});
+    int n = _workers.Count ();
+    for (int i = 0; i < n; i++) {
+        auto w = _workers[i];
+        w->Jobs = List<int> {}, w->Head = 0, w->Tail = 0;
+        FFD_DESTROY_OBJECT(w->Ahead, FFDPrefetch)
+        w->Ahead = nullptr;
+        if (_prefetch > 0)
+            FFD_CREATE_OBJECT(w->Ahead, FFDPrefetch) {_prefetch, _uring};
+    }
+    for (int i = 0; i < _files.Count (); i++) {
+        auto w = _workers[i % n];
+        w->Jobs.Add (i), w->Tail++;
+    }
+    // the caller is worker 0
+    for (int i = 1; i < n; i++)
+        FFD_ENSURE(0 == pthread_create (&(_workers[i]->Thread), nullptr,
+            FFDCorpus::Work, _workers[i]), "FFDCorpus: pthread_create failed")
+    Work (_workers[0]);
+    for (int i = 1; i < n; i++) pthread_join (_workers[i]->Thread, nullptr);
+    _client = nullptr;
+}// FFDCorpus::Run()
+
+size_t FFDCorpus::ArenaPeak() const
+{
+    size_t peak {};
+    for (int i = 0; i < _workers.Count (); i++)
+        for (auto a : _workers[i]->Arenas)
+            if (a->Arena.Peak () > peak) peak = a->Arena.Peak ();
+    return peak;
+}
+
+size_t FFDCorpus::ArenaReserved() const
+{
+    size_t reserved {};
+    for (int i = 0; i < _workers.Count (); i++)
+        for (auto a : _workers[i]->Arenas) reserved += a->Arena.Reserved ();
+    return reserved;
+}
+
+NAMESPACE_FFD
@@ -0,0 +1,143 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// Many files, one description: a fixed pool of worker threads, each with its
+// own ParseContext; work-stealing instead of a shared queue.
+
+#ifndef _FFD_CORPUS_H_
+#define _FFD_CORPUS_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+#include <pthread.h>
+
+FFD_NAMESPACE
+
+class FFDNode;
+class FFDPrefetch;
+class FFDMemoryStream;
+
+// Usage:
+//   FFDCorpus corpus {ffd};
+//   corpus.AddDirectory ("dir", "nif,kf");
+//   corpus.Run (client);
+// Jobs are dealt round-robin to the workers: each one takes its lowest index
+// first, and steals the highest index of another one when it runs out. So
+// the files are parsed in roughly Add() order - what the ordered Run() needs
+// to keep few trees waiting.
+class FFD_EXPORT FFDCorpus final
+{
+    public: struct Result final
+    {
+        int Index {};                 // Add() order
+        const char * FileName {};
+        int Worker {};
+        FFDNode * Tree {};            // null when Open() returned null
+        bool Skipped {};              // FFD::ParseContext::Skip
+        off_t Unread {};              // stream Size () - Tell () after it
+    };
+    // Implement it. Open() is called by the workers - at the same time.
+    public: class Client
+    {
+        // The stream of "file_name". Keep one per "worker" and re-open it:
+        // it is used until the next Open() by the same worker. Null: skip it.
+        // Not called when Prefetch() is on.
+        public: virtual Stream * Open(int worker, const char * file_name) = 0;
+        // Prefetch(): instead of Open() - "data" is the file, read whole;
+        // valid until the next Opened() by the same worker. Null: skip it.
+        public: virtual Stream * Opened(int worker, const char * file_name,
+            FFDMemoryStream & data);
+        // By the workers, at the same time - unless Run() is ordered: then
+        // one at a time, in Add() order. The tree is freed on return: it is
+        // allocated from an FFDArena of the worker.
+        public: virtual void Parsed(const Result &) {}
+        public: virtual ~Client() {}
+    };
+
+    // "workers": 0 - one per online CPU.
+    public: FFDCorpus(const FFD &, int workers = 0);
+    public: ~FFDCorpus();
+
+    public: void Add(const char * file_name);
+    // Recursive. "ext_list": "a,b,c"; returns the number of files added.
+    public: int AddDirectory(const char * path, const char * ext_list);
+    public: inline int Count() const { return _files.Count (); }
+    public: inline int Workers() const { return _workers.Count (); }
+    // Parses all added files; returns when they're done. Not re-entrant.
+    public: void Run(Client &, bool ordered = false);
+    // Each worker reads the next "depth" files it is to parse while parsing
+    // - see FFDPrefetch - and gives them to Client::Opened(). 0: off, the
+    // default; Open() it is. "uring": false - the reader threads.
+    public: inline void Prefetch(int depth, bool uring = true)
+    {
+        _prefetch = depth, _uring = uring;
+    }
+    // The largest FFDArena::Peak() of the workers [bytes].
+    public: size_t ArenaPeak() const;
+    // What their arenas hold now: FFDArena::Reserved(), all of them [bytes].
+    public: size_t ArenaReserved() const;
+
+    private: struct Worker;
+    private: struct Slot;
+    private: const FFD & _ffd;
+    private: List<String> _files {};
+    private: List<Worker *> _workers {};
+    private: Client * _client {};
+    private: bool _ordered {};
+    private: int _prefetch {};
+    private: bool _uring {true};
+    // ordered: the results waiting for the ones prior them; one worker at a
+    // time reports them
+    private: struct Pending final
+    {
+        Result R {};
+        Slot * Held {};
+        bool Done {};
+    };
+    private: List<Pending> _pending {};
+    private: int _next {};
+    private: bool _draining {};
+    private: pthread_mutex_t _order_lock;
+
+    private: static void * Work(void *);
+    private: void Parse(Worker &, int job, Stream *);
+    private: int Take(Worker &);
+    private: void Report(const Result &, Slot *);
+    private: void Release(const Result &, Slot *);
+};// FFDCorpus
+
+NAMESPACE_FFD
+
+#endif
@@ -37,6 +37,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ffd_model.h"
 
+// Levels. The ones below FFD_DBG_LEVEL are compiled out; the rest are
+// filtered by the channel at run-time. A filtered one doesn't evaluate its
+// arguments: don't put side effects there.
+#define FFD_DBG_TRACE 0 // per field, per file
+#define FFD_DBG_DEBUG 1 // per description, per file
+#define FFD_DBG_INFO  2 // warnings
+#ifndef FFD_DBG_LEVEL
+# ifdef FFD_DEBUG
+#  define FFD_DBG_LEVEL FFD_DBG_TRACE
+# else
+#  define FFD_DBG_LEVEL FFD_DBG_INFO
+# endif
+#endif
+
 FFD_NAMESPACE
 
 // Convenience.
@@ -72,8 +86,12 @@ struct UnqueuedThreadSafeDebugLog final
     }
     inline L & operator<<(void * & v) { return Fmt ("%p", v); }
     inline L & operator<<(L & l) { return l; }
+    inline bool On(int level) const { return Enabled && level >= Level; }
+    // "c ? (void)0 : Void {} & log << a << b": a statement, no dangling else
+    struct Void final { inline void operator&(L &) {} };
 
     bool Enabled{true};
+    int Level{FFD_DBG_TRACE};
     const char * const Channel;
     FFD_EXPORT static UnqueuedThreadSafeDebugLog & D();
     UnqueuedThreadSafeDebugLog(const char * c = nullptr, bool e = true)
@@ -90,4 +108,14 @@ NAMESPACE_FFD
 // You can either ".Enabled = false" or "DBG_CHANNEL(,,false)"
 #define DBG_CHANNEL(V,N,E) auto V ::FFD_NS::UnqueuedThreadSafeDebugLog {N, E};
 
+// "DBG_AT(channel, FFD_DBG_DEBUG) << a << b;" - a and b are evaluated only
+// when it gets printed. "if (DBG_ON(FFD_DBG_TRACE)) n->DbgPrint ();"
+#define DBG_ON_CHANNEL(V,L) ((L) >= FFD_DBG_LEVEL && (V).On (L))
+#define DBG_AT(V,L) ! DBG_ON_CHANNEL(V,L) ? (void)0 \
+    : ::FFD_NS::UnqueuedThreadSafeDebugLog::Void {} & (V)
+#define DBG_ON(L) DBG_ON_CHANNEL(Dbg,L)
+#define DbgT DBG_AT(Dbg, FFD_DBG_TRACE)
+#define DbgD DBG_AT(Dbg, FFD_DBG_DEBUG)
+#define DbgI DBG_AT(Dbg, FFD_DBG_INFO)
+
 #endif
\ No newline at end of file
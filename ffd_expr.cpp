@@ -0,0 +1,82 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_expr.h"
+
+FFD_NAMESPACE
+
+FFDExpr::FFDExpr(FFD::SNode * sn, FFD::SNode * head)
+{
+    FFD_ENSURE(nullptr != sn && nullptr != head, "FFDExpr: null node")
+    FFD_ENSURE(nullptr != sn->Names, "FFDExpr: FFD::NumberNodes() first")
+    // FFDNode::ResolveSNode() looks at the root-level ones; from any struct
+    // the set is the same
+    auto root = sn->Base ? sn->Base : sn;
+    for (auto & t : sn->Expr) {
+        Step step {};
+        step.Type = t.Type, step.Value = t.Value;
+        if (FFDParser::ExprTokenType::Symbol == t.Type) {
+            Symbol sym {};
+            sym.Name = t.Symbol;
+            sym.Path = static_cast<List<String> &&>(sym.Name.Split ('.'));
+            sym.NameId = sn->Names->IndexOf (sym.Name);
+            for (auto & name : sym.Path)
+                sym.PathIds.Add (sn->Names->IndexOf (name));
+            int found {};
+            for (auto m : root->NodesByName (t.Symbol))
+                if (m->IsConst () || m->IsMachType () || m->IsEnum ()) {
+                    found++;
+                    sym.Const = m->IsIntConst () && ! m->HasExpr ();
+                    sym.Value = m->IntLiteral;
+                }
+            if (found > 1 || (found && ! sym.Const)) {
+                DbgD << "FFDExpr: runtime symbol: " << t.Symbol << EOL;
+                _valid = false;
+                return;
+            }
+            head->WalkForward ([&](FFD::SNode * n) {
+                if (! n->IsEnum ()) return true;
+                auto itm = n->FindEnumItem (t.Symbol);
+                if (itm && sym.Enum) return sym.Enum = nullptr, false;
+                if (itm) sym.Enum = n, sym.EnumValue = itm->Value;
+                return true;
+            });
+            step.Symbol = _symbols.Count ();
+            _symbols.Put (static_cast<Symbol &&>(sym));
+        }
+        _steps.Put (static_cast<Step &&>(step));
+    }
+}// FFDExpr::FFDExpr()
+
+NAMESPACE_FFD
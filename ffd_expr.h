@@ -0,0 +1,88 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// (a.b == X) - pre-processed once, evaluated per file
+
+#ifndef _FFD_EXPR_H_
+#define _FFD_EXPR_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+FFD_NAMESPACE
+
+// SNode::Expr, with what doesn't depend on the data looked up already:
+// "a.b.c" split, root-level int consts folded, and enum items named by
+// the right operand folded when only one enum has them. FFDNode evaluates
+// it the way it does the tokens - same quirks - minus the string work.
+// Not created when one of the symbols needs a runtime lookup among the
+// root-level nodes (conditional consts, implicit machine types, ...).
+class FFD_EXPORT FFDExpr final
+{
+    public: struct Symbol final
+    {
+        String Name {};
+        List<String> Path {}; // Name.Split ('.')
+        int NameId {-1};      // see FFD::SNode::NameId
+        List<int> PathIds {};
+        bool Const {}; // a root-level int const; "Value" is it
+        int Value {};
+        FFD::SNode * Enum {}; // the only enum having an item named "Name"
+        int EnumValue {};
+    };
+    public: struct Step final // one per token
+    {
+        FFDParser::ExprTokenType Type {};
+        int Value {};
+        int Symbol {-1}; // index at Symbols
+    };
+
+    // "sn" - the node having the Expr; "head" - the 1st node of the
+    // description.
+    public: FFDExpr(FFD::SNode * sn, FFD::SNode * head);
+    public: ~FFDExpr() {}
+
+    public: inline bool Valid() const { return _valid; }
+    public: inline int Count() const { return _steps.Count (); }
+    public: inline const Step & operator[](int i) const { return _steps[i]; }
+    public: inline const Symbol & SymbolAt(int i) const { return _symbols[i]; }
+
+    private: List<Step> _steps {};
+    private: List<Symbol> _symbols {};
+    private: bool _valid {true};
+};// FFDExpr
+
+NAMESPACE_FFD
+
+#endif
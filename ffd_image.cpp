@@ -0,0 +1,347 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// FFD::Save(), FFD::Load(): the parsed description, as a binary image.
+//
+// Layout: header, then the nodes, depth first: root nodes in description
+// order, each followed by its fields. Nodes refer to each other by that
+// index, so there is nothing to relocate. 32-bit ints, host byte order;
+// strings are length-prefixed.
+
+#include "ffd.h"
+
+#include <new>
+
+FFD_NAMESPACE
+
+#define FFD_IMAGE_MAGIC 0x49444646 // "FFDI"
+#define FFD_IMAGE_VERSION 2
+#define FFD_IMAGE_HEADER_INTS 7
+
+// FNV-1a; 4 bytes a step. Modulo 2^32 in 64 bits: it doesn't wrap - no
+// reports from -fsanitize=integer.
+/*static*/ unsigned int FFD::Checksum(const byte * p, int len)
+{
+    unsigned long long h {2166136261u};
+    unsigned int w {};
+    int i {};
+    for (; i + 4 <= len; i += 4)
+        OS::Memcpy (&w, p + i, 4), h = ((h ^ w) * 16777619u) & 0xffffffffu;
+    for (; i < len; i++) h = ((h ^ p[i]) * 16777619u) & 0xffffffffu;
+    return static_cast<unsigned int>(h);
+}
+
+class ImageWriter final
+{
+    public: inline void Int(int v) { Bytes (&v, sizeof(v)); }
+    public: inline void Str(const String & s)
+    {
+        Int (s.Length ()), Bytes (s.AsZStr (), s.Length ());
+    }
+    public: inline void Bytes(const void * p, int n)
+    {
+        if (_len + n > _buf.Length ())
+            _buf.Resize (_len + n > 1<<12 ? (_len + n) * 2 : 1<<12);
+        OS::Memcpy (_buf.operator byte * () + _len, p, n);
+        _len += n;
+    }
+    public: inline const byte * Data() const { return _buf.operator byte * (); }
+    public: inline int Length() const { return _len; }
+    private: ByteArray _buf {};
+    private: int _len {};
+};// ImageWriter
+
+// Out of range reads yield 0 and clear Ok().
+class ImageReader final
+{
+    public: ImageReader(const byte * p, int len) : _p{p}, _len{len} {}
+    public: inline int Int()
+    {
+        int v {};
+        if (! Has (sizeof(v))) return 0;
+        OS::Memcpy (&v, _p + _pos, sizeof(v));
+        return _pos += sizeof(v), v;
+    }
+    public: inline String Str()
+    {
+        int n = Int ();
+        if (n < 0 || ! Has (n)) return String {};
+        String s {_p + _pos, n};
+        return _pos += n, static_cast<String &&>(s);
+    }
+    public: inline bool Ok() const { return _ok; }
+    public: inline bool AtEnd() const { return _pos == _len; }
+    private: inline bool Has(int n)
+    {
+        if (n > _len - _pos) _ok = false;
+        return _ok;
+    }
+    private: const byte * _p;
+    private: int _len;
+    private: int _pos {};
+    private: bool _ok {true};
+};// ImageReader
+
+// SNode * -> its index at the image; open addressing.
+class NodeIndex final
+{
+    public: NodeIndex(int count)
+    {
+        int size {16};
+        while (size < count * 2) size <<= 1;
+        for (int i = 0; i < size; i++) _keys.Add (nullptr), _values.Add (-1);
+    }
+    public: inline void Add(const FFD::SNode * n, int index)
+    {
+        int i = Slot (n);
+        _keys[i] = n, _values[i] = index;
+    }
+    // -1 for null
+    public: inline int Of(const FFD::SNode * n) const
+    {
+        return nullptr == n ? -1 : _values[Slot (n)];
+    }
+    private: inline int Slot(const FFD::SNode * n) const
+    {
+        auto mask = static_cast<unsigned int>(_keys.Count () - 1);
+        // 32 bits by 32 bits: no wrapping either
+        auto i = static_cast<unsigned int>(((reinterpret_cast<size_t>(n) >> 4)
+            & 0xffffffffu) * 2654435761ull) & mask;
+        while (_keys[i] && _keys[i] != n) i = (i + 1) & mask;
+        return i;
+    }
+    private: List<const FFD::SNode *> _keys {};
+    private: List<int> _values {};
+};// NodeIndex
+
+static void index_node(NodeIndex & idx, FFD::SNode * n, int & count)
+{
+    idx.Add (n, count++);
+    for (auto f : n->Fields) index_node (idx, f, count);
+}
+
+static void save_expr(ImageWriter & w, const List<FFDParser::ExprToken> & e)
+{
+    w.Int (e.Count ());
+    for (auto & t : e)
+        w.Int (static_cast<int>(t.Type)), w.Int (t.Value), w.Str (t.Symbol);
+}
+
+static void save_node(ImageWriter & w, const NodeIndex & idx, FFD::SNode * n)
+{
+    w.Int (static_cast<int>(n->Type));
+    w.Int (idx.Of (n->Base));
+    w.Int (idx.Of (n->DType));
+    w.Int (n->HashKey | n->Array << 1 | n->Variadic << 2 | n->VListItem << 3
+        | n->Composite << 4 | n->Signed << 5 | n->Fp << 6
+        | static_cast<int>(n->Order) << 7);
+    w.Int (static_cast<int>(n->Const));
+    w.Int (n->IntLiteral);
+    w.Int (n->Size);
+    w.Str (n->Attribute), w.Str (n->Name), w.Str (n->DTypeName);
+    w.Str (n->Comment), w.Str (n->HashType), w.Str (n->StringLiteral);
+    save_expr (w, n->Expr);
+    for (auto & d : n->Arr) w.Str (d.Name), w.Int (d.Value);
+    w.Int (n->ValueList.Count ());
+    for (auto & v : n->ValueList) w.Int (v.A), w.Int (v.B);
+    w.Int (n->EnumItems.Count ());
+    for (auto & i : n->EnumItems) {
+        w.Str (i.Name), w.Int (i.Value);
+        save_expr (w, i.Expr);
+        w.Int (i.Enabled);
+    }
+    w.Int (n->PS.Count ());
+    for (auto & p : n->PS)
+        w.Int (static_cast<int>(p.Type)), w.Str (p.Name), w.Str (p.Bind),
+            w.Int (p.Value);
+    w.Int (n->Fields.Count ());
+    for (auto f : n->Fields) save_node (w, idx, f);
+}// save_node()
+
+static int count_nodes(FFD::SNode * n)
+{
+    int count {1};
+    for (auto f : n->Fields) count += count_nodes (f);
+    return count;
+}
+
+void FFD::Save(Stream & s) const
+{
+    FFD_ENSURE(nullptr != _head, "Save(): empty description")
+    int count {}, roots {};
+    _head->WalkForward ([&](SNode * n) {
+        return count += count_nodes (n), roots++, true;
+    });
+    NodeIndex idx {count};
+    count = 0;
+    _head->WalkForward ([&](SNode * n) {
+        return index_node (idx, n, count), true;
+    });
+    ImageWriter w {};
+    _head->WalkForward ([&](SNode * n) { return save_node (w, idx, n), true; });
+    int header[FFD_IMAGE_HEADER_INTS] {FFD_IMAGE_MAGIC, FFD_IMAGE_VERSION,
+        _text_len, static_cast<int>(_text_checksum), roots, w.Length (),
+        static_cast<int>(Checksum (w.Data (), w.Length ()))};
+    s.Write (header, sizeof(header));
+    s.Write (w.Data (), w.Length ());
+}// FFD::Save()
+
+static void load_expr(ImageReader & r, List<FFDParser::ExprToken> & e)
+{
+    for (int i = 0, n = r.Int (); i < n && r.Ok (); i++) {
+        FFDParser::ExprToken t {
+            static_cast<FFDParser::ExprTokenType>(r.Int ())};
+        t.Value = r.Int ();
+        t.Symbol = static_cast<String &&>(r.Str ());
+        e.Put (static_cast<FFDParser::ExprToken &&>(t));
+    }
+}
+
+// "nodes", "refs": by index; refs: Base and DType - resolved once all nodes
+// are loaded.
+static FFD::SNode * load_node(ImageReader & r, List<FFD::SNode *> & nodes,
+    List<int> & refs)
+{
+    FFD::SNode * n {};
+    FFD_CREATE_OBJECT(n, FFD::SNode) {};
+    nodes.Add (n);
+    n->Type = static_cast<FFD::SType>(r.Int ());
+    refs.Add (r.Int ()), refs.Add (r.Int ());
+    int flags = r.Int ();
+    n->HashKey = flags & 1, n->Array = flags & 2, n->Variadic = flags & 4;
+    n->VListItem = flags & 8, n->Composite = flags & 16;
+    n->Signed = flags & 32, n->Fp = flags & 64;
+    n->Order = static_cast<FFD::SByteOrder>(flags >> 7 & 3);
+    n->Const = static_cast<FFD::SConstType>(r.Int ());
+    n->IntLiteral = r.Int ();
+    n->Size = r.Int ();
+    n->Attribute = static_cast<String &&>(r.Str ());
+    n->Name = static_cast<String &&>(r.Str ());
+    n->DTypeName = static_cast<String &&>(r.Str ());
+    n->Comment = static_cast<String &&>(r.Str ());
+    n->HashType = static_cast<String &&>(r.Str ());
+    n->StringLiteral = static_cast<String &&>(r.Str ());
+    load_expr (r, n->Expr);
+    for (auto & d : n->Arr)
+        d.Name = static_cast<String &&>(r.Str ()), d.Value = r.Int ();
+    for (int i = 0, c = r.Int (); i < c && r.Ok (); i++) {
+        FFDParser::VLItem v {};
+        v.A = r.Int (), v.B = r.Int ();
+        n->ValueList.Add (v);
+    }
+    for (int i = 0, c = r.Int (); i < c && r.Ok (); i++) {
+        FFD::EnumItem itm {};
+        itm.Name = static_cast<String &&>(r.Str ());
+        itm.Value = r.Int ();
+        load_expr (r, itm.Expr);
+        itm.Enabled = r.Int ();
+        n->EnumItems.Put (static_cast<FFD::EnumItem &&>(itm));
+    }
+    for (int i = 0, c = r.Int (); i < c && r.Ok (); i++) {
+        auto type = static_cast<FFD::SNode::PSType>(r.Int ());
+        n->PS.Put (FFD::SNode::PSParam {static_cast<String &&>(r.Str ())});
+        auto & p = n->PS[n->PS.Count () - 1];
+        p.Type = type;
+        p.Bind = static_cast<String &&>(r.Str ());
+        p.Value = r.Int ();
+    }
+    for (int i = 0, c = r.Int (); i < c && r.Ok (); i++) {
+        auto f = load_node (r, nodes, refs);
+        if (f) n->Fields.Add (f);
+    }
+    if (r.Ok ()) return n;
+    FFD_DESTROY_NESTED_OBJECT(n, FFD::SNode, SNode)
+    return nullptr;
+}// load_node()
+
+/*static*/ FFD * FFD::Load(const byte * image, int len, const byte * text,
+    int text_len)
+{
+    ImageReader r {image, len};
+    int header[FFD_IMAGE_HEADER_INTS] {};
+    for (auto & h : header) h = r.Int ();
+    if (! r.Ok () || FFD_IMAGE_MAGIC != header[0]
+        || FFD_IMAGE_VERSION != header[1]) return nullptr;
+    auto text_checksum = Checksum (text, text_len);
+    if (text_len != header[2]
+        || static_cast<int>(text_checksum) != header[3]) return nullptr;
+    int roots = header[4], payload = header[5];
+    auto data = image + FFD_IMAGE_HEADER_INTS * sizeof(int);
+    if (roots <= 0
+        || payload != len - static_cast<int>(
+            FFD_IMAGE_HEADER_INTS * sizeof(int))
+        || static_cast<int>(Checksum (data, payload)) != header[6])
+        return nullptr;
+
+    FFD * ffd {};
+    FFD_CREATE_OBJECT(ffd, FFD) {};
+    ffd->_text_len = text_len, ffd->_text_checksum = text_checksum;
+    List<SNode *> nodes {};
+    List<int> refs {};
+    for (int i = 0; i < roots && r.Ok (); i++) {
+        auto node = load_node (r, nodes, refs);
+        if (! node) break;
+        node->Prev = ffd->_tail;
+        if (ffd->_tail) ffd->_tail->Next = node;
+        else ffd->_head = node;
+        ffd->_tail = node;
+        node->Ordinal = i;
+        node->Symbols = &(ffd->_symbols);
+        ffd->_symbols.Add (node);
+        if (node->IsRoot ()) ffd->_root = node;
+    }
+    bool ok = r.Ok () && r.AtEnd ();
+    for (int i = 0; i < nodes.Count () && ok; i++) {
+        int base = refs[2*i], dtype = refs[2*i+1];
+        ok = base >= -1 && base < nodes.Count ()
+            && dtype >= -1 && dtype < nodes.Count ();
+        if (! ok) break;
+        nodes[i]->Base = base < 0 ? nullptr : nodes[base];
+        nodes[i]->DType = dtype < 0 ? nullptr : nodes[dtype];
+    }
+    if (! ok) {
+        FFD_DESTROY_OBJECT(ffd, FFD)
+        return nullptr;
+    }
+    ffd->ResolveByteOrder ();
+    ffd->NumberNodes ();
+    ffd->CompileExpressions ();
+    return ffd;
+}// FFD::Load()
+
+#undef FFD_IMAGE_HEADER_INTS
+#undef FFD_IMAGE_VERSION
+#undef FFD_IMAGE_MAGIC
+
+NAMESPACE_FFD
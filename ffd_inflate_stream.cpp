@@ -0,0 +1,174 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_inflate_stream.h"
+
+#include <zlib.h>
+
+FFD_NAMESPACE
+
+FFDInflateStream::FFDInflateStream(Stream * s, int size, int usize,
+    bool gzip)
+    : FFDMemoryStream {}, _gzip {gzip}
+{
+    FFD_ENSURE(nullptr != s, "FFDInflateStream: null stream")
+    FFD_ENSURE(size > 0 && usize > 0, "FFDInflateStream: bad size")
+    FFD_ENSURE(usize <= MAX_SIZE && usize / MAX_RATIO <= size,
+        "FFDInflateStream: suspicious usize")
+    _in.Resize (size);
+    s->Read (_in.operator byte * (), size);
+    OS::Alloc (_out, usize);
+    _p = _out, _size = _room = usize;
+    _mark = 1; // nothing is ready
+    pthread_mutex_init (&_lock, nullptr);
+    pthread_cond_init (&_more, nullptr);
+    FFD_ENSURE(0 == pthread_create (&_thread, nullptr,
+        FFDInflateStream::Inflate, this),
+        "FFDInflateStream: pthread_create failed")
+}
+
+FFDInflateStream::~FFDInflateStream()
+{
+    pthread_mutex_lock (&_lock);
+    _stop = true;
+    pthread_mutex_unlock (&_lock);
+    pthread_join (_thread, nullptr);
+    pthread_cond_destroy (&_more);
+    pthread_mutex_destroy (&_lock);
+    for (auto p : _spent) OS::Free (p);
+    OS::Free (_out);
+}
+
+int FFDInflateStream::Ready()
+{
+    pthread_mutex_lock (&_lock);
+    int ready = _ready;
+    pthread_mutex_unlock (&_lock);
+    return ready;
+}
+
+off_t FFDInflateStream::Size() const
+{
+    pthread_mutex_lock (&_lock);
+    off_t size = _done && ! _failed ? _ready : _room;
+    pthread_mutex_unlock (&_lock);
+    return size;
+}
+
+int FFDInflateStream::Inflated()
+{
+    pthread_mutex_lock (&_lock);
+    while (! _done) pthread_cond_wait (&_more, &_lock);
+    int size = _failed ? -1 : _ready;
+    pthread_mutex_unlock (&_lock);
+    return size;
+}
+
+// _out, a BLOCK at a time; _in is all there is. Full, and not at the end:
+// the usize given was short - a new _out, twice the size; the reader frees
+// the old one, see Wait().
+/*static*/ void * FFDInflateStream::Inflate(void * p)
+{
+    auto & z = *static_cast<FFDInflateStream *>(p);
+    z_stream zs {};
+    bool ok = Z_OK == inflateInit2 (&zs, z._gzip ? 31 : 15), end {};
+    zs.next_in = static_cast<z_const Bytef *>(z._in.operator byte * ());
+    zs.avail_in = static_cast<uInt>(z._in.Length ()); // zlib: uInt
+    byte * out = z._out, * spent {};
+    int at {}, size = z._room;
+    for (bool stop {}; ok && ! stop && ! end;) {
+        if (at < size) {
+            int n = size - at < BLOCK ? size - at : BLOCK;
+            zs.next_out = static_cast<Bytef *>(out + at);
+            zs.avail_out = static_cast<uInt>(n);
+            int r = inflate (&zs, Z_NO_FLUSH);
+            at += n - static_cast<int>(zs.avail_out);
+            // Z_BUF_ERROR: no progress - the input is short
+            end = Z_STREAM_END == r, ok = Z_OK == r || end;
+        }
+        else { // one byte more: the end, or it grows
+            byte b {};
+            zs.next_out = static_cast<Bytef *>(&b), zs.avail_out = 1;
+            int r = inflate (&zs, Z_NO_FLUSH);
+            end = Z_STREAM_END == r, ok = Z_OK == r || end;
+            if (! ok || zs.avail_out) break;
+            if (size >= MAX_SIZE) { ok = false; break; }
+            size = size > MAX_SIZE / 2 ? MAX_SIZE : 2 * size;
+            byte * q {};
+            OS::Alloc (q, size);
+            OS::Memcpy (q, out, at);
+            q[at++] = b;
+            spent = out, out = q;
+        }
+        pthread_mutex_lock (&z._lock);
+        if (spent) z._spent.Add (spent), spent = nullptr;
+        z._out = out, z._room = size, z._ready = at, stop = z._stop;
+        pthread_cond_broadcast (&z._more);
+        pthread_mutex_unlock (&z._lock);
+    }
+    inflateEnd (&zs);
+    pthread_mutex_lock (&z._lock);
+    z._done = true, z._failed = ! end;
+    pthread_cond_broadcast (&z._more);
+    pthread_mutex_unlock (&z._lock);
+    return nullptr;
+}
+
+int FFDInflateStream::Wait(off_t pos)
+{
+    pthread_mutex_lock (&_lock);
+    while (_ready < pos && ! _done) pthread_cond_wait (&_more, &_lock);
+    int ready = _ready;
+    bool whole = _done && ! _failed;
+    if (_p != _out) { // it grew: none of the old ones is read from now on
+        for (auto p : _spent) OS::Free (p);
+        _spent = List<byte *> {};
+    }
+    _p = _out, _size = whole ? ready : _room;
+    _mark = whole ? NO_MARK : ready + 1;
+    pthread_mutex_unlock (&_lock);
+    return ready;
+}
+
+void FFDInflateStream::Mark()
+{
+    FFD_ENSURE(Wait (_pos) >= _pos, "FFDInflateStream: inflate() failed")
+}
+
+void FFDInflateStream::Short(size_t n)
+{
+    Wait (_pos + static_cast<off_t>(n));
+}
+
+NAMESPACE_FFD
@@ -0,0 +1,104 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// A zlib/gzip stream, inflated by a thread of its own while it is parsed.
+
+#ifndef _FFD_INFLATE_STREAM_H_
+#define _FFD_INFLATE_STREAM_H_
+
+#include "ffd_model.h"
+#include "ffd_memory_stream.h"
+
+#include <pthread.h>
+
+FFD_NAMESPACE
+
+// Usage:
+//   int usize {};
+//   s.Seek (size - 4).Read (&usize, 4).Reset (); // gzip ISIZE
+//   FFDInflateStream z {&s, size, usize, true};
+//   auto tree = ffd.File2Tree (z);
+// The size is known up front: the output is one buffer of "usize" bytes,
+// filled a block at a time by the thread; reading waits only for a block not
+// yet inflated - see Mark(). So it is an FFDMemoryStream: the nodes read it
+// inline, and it seeks back and forth as any other. The compressed bytes are
+// read by the constructor: "s" is not used after it.
+// "usize" comes from the file - ISIZE is the size modulo 2^32 at that: it
+// is checked against MAX_SIZE and against what deflate can make of "size"
+// bytes. Should the inflate make more of them, the buffer grows: into a new
+// one, twice the size; the old one is freed once the reader moved off it -
+// what Take() returned is valid till the next Take() or Seek().
+// Not a ring of blocks: the nodes seek back (Reset(), the lazy and the huge
+// ones), so all of it is kept; it is as much as inflating it up front takes.
+class FFD_EXPORT FFDInflateStream final : public FFDMemoryStream
+{
+    // "size" bytes of "s", from Tell(): inflated, "usize" bytes; "gzip":
+    // with the gzip header and footer, zlib otherwise.
+    public: FFDInflateStream(Stream * s, int size, int usize,
+        bool gzip = true);
+    public: ~FFDInflateStream() override;
+
+    public: static int constexpr MAX_SIZE {1<<30}; // [bytes] inflated
+    // Inflated so far [bytes]; Size() when done.
+    public: int Ready();
+    // Doesn't wait: "usize" (or the room it grew to) till the inflate is
+    // done, what it came to then. A read past what it comes to fails.
+    public: off_t Size() const override;
+    // Waits for the inflate to be done: "usize" is what it was told, this
+    // is what it came to; -1: inflate() failed.
+    public: int Inflated();
+
+    private: ByteArray _in {};
+    private: bool _gzip;
+    private: pthread_t _thread {};
+    private: mutable pthread_mutex_t _lock;
+    private: mutable pthread_cond_t _more;
+    private: byte * _out {};            // by _lock; the thread's
+    private: int _room {}, _ready {};   // by _lock; _out: [bytes]
+    private: bool _done {}, _failed {}, _stop {}; // by _lock
+    private: List<byte *> _spent {};    // by _lock; _out grew out of them
+    private: static int constexpr BLOCK {1<<16}; // [bytes] per wake-up
+    private: static int constexpr MAX_RATIO {1032}; // deflate: at most
+    private: static void * Inflate(void *);
+    // Tell() is past what is ready: it waits for it.
+    private: void Mark() override;
+    private: void Short(size_t) override;
+    // Till "pos" is ready, or the thread is done; _p, _size, _mark: its.
+    // Returns what is ready.
+    private: int Wait(off_t pos);
+};// FFDInflateStream
+
+NAMESPACE_FFD
+
+#endif
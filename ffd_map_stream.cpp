@@ -0,0 +1,80 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_map_stream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+FFD_NAMESPACE
+
+FFDMapStream::FFDMapStream(const char * file_name)
+{
+    int fd = open (file_name, O_RDONLY);
+    if (fd < 0) return;
+    struct stat st {};
+    if (0 == fstat (fd, &st) && S_ISREG(st.st_mode)) {
+        if (0 == st.st_size) _ok = true;
+        else {
+            void * p = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd,
+                0);
+            if (MAP_FAILED != p) {
+                _p = static_cast<const byte *>(p), _size = st.st_size;
+                _ok = true;
+                madvise (p, _size, MADV_SEQUENTIAL);
+                Mark ();
+            }
+        }
+    }
+    close (fd); // the mapping keeps the file
+}
+
+FFDMapStream::~FFDMapStream()
+{
+    if (_p) munmap (const_cast<byte *>(_p), _size), _p = nullptr;
+}
+
+void FFDMapStream::Mark()
+{
+    auto page = static_cast<off_t>(sysconf (_SC_PAGESIZE));
+    auto from = _pos & ~(page - 1);
+    auto to = _pos + WINDOW < _size ? _pos + WINDOW : _size;
+    if (to > from)
+        madvise (const_cast<byte *>(_p) + from, to - from, MADV_WILLNEED);
+    _mark = to < _size ? _pos + WINDOW / 2 : NO_MARK, _back = from;
+}
+
+NAMESPACE_FFD
@@ -0,0 +1,70 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// A file, mapped: an FFDMemoryStream whose bytes are the mapping.
+// Set it as FFD::ParseContext::Map and the FFDNode data are views into it.
+
+#ifndef _FFD_MAP_STREAM_H_
+#define _FFD_MAP_STREAM_H_
+
+#include "ffd_memory_stream.h"
+
+FFD_NAMESPACE
+
+// Usage:
+//   FFDMapStream s {"file"};
+//   if (! s) ... can't open it
+//   FFD::ParseContext ctx {ffd};
+//   ctx.Map = &s;
+//   auto tree = ffd.File2Tree (s, ctx); // valid while "s" is
+// The kernel is told the access is sequential, and the window ahead of
+// Tell() is requested as parsing moves - forward or back.
+class FFD_EXPORT FFDMapStream final : public FFDMemoryStream
+{
+    public: FFDMapStream(const char * file_name);
+    public: ~FFDMapStream() override;
+
+    public: inline explicit operator bool() const { return _ok; }
+
+    // [bytes] the madvise(MADV_WILLNEED) window
+    private: static off_t constexpr WINDOW {4<<20};
+    private: bool _ok {};
+    // MADV_WILLNEED from Tell() to WINDOW past it; again at WINDOW / 2, or
+    // when a Seek() goes back before it.
+    private: void Mark() override;
+};// FFDMapStream
+
+NAMESPACE_FFD
+
+#endif
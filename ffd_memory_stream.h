@@ -0,0 +1,127 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// A Stream over bytes already in memory. FFD::File2Tree() recognizes it (see
+// Stream::Memory()) and FFDNode reads it with an inline cursor: no virtual
+// call, no copy to a stream buffer of its own.
+
+#ifndef _FFD_MEMORY_STREAM_H_
+#define _FFD_MEMORY_STREAM_H_
+
+#include "ffd_model.h"
+
+FFD_NAMESPACE
+
+// Usage:
+//   FFDMemoryStream s {buf, size}; // "buf" outlives "s"
+//   auto tree = ffd.File2Tree (s);
+class FFD_EXPORT FFDMemoryStream : public Stream
+{
+    public: FFDMemoryStream(const byte * data, size_t size)
+        : _p {data}, _size {static_cast<off_t>(size)} {}
+    public: ~FFDMemoryStream() override {}
+    public: FFDMemoryStream(const FFDMemoryStream &) = delete;
+    public: FFDMemoryStream & operator=(const FFDMemoryStream &) = delete;
+
+    public: Stream & Read(void * v, size_t n) final
+    {
+        return Get (v, n), *this;
+    }
+    public: off_t Tell() const final { return _pos; }
+    public: off_t Size() const override { return _size; }
+    public: Stream & Seek(off_t ofs) final
+    {
+        if (_pos + ofs > _size) Short (static_cast<size_t>(ofs));
+        FFD_ENSURE(_pos + ofs >= 0 && _pos + ofs <= _size,
+            "FFDMemoryStream: seek out of range")
+        _pos += ofs;
+        if (_pos >= _mark || _pos < _back) Mark ();
+        return *this;
+    }
+    public: Stream & Reset() final { return Seek (-_pos); }
+    public: FFDMemoryStream * Memory() final { return this; }
+    public: const byte * Peek(size_t n) final
+    {
+        auto result = Take (n); // Mark(): so they're there
+        return _pos -= n, result;
+    }
+    public: const byte * Borrow(size_t n) final { return Take (n); }
+
+    // The non-virtual ones.
+    // The next "n" bytes: where they are; Tell() moves past them.
+    public: inline const byte * Take(size_t n)
+    {
+        if (n > static_cast<size_t>(_size - _pos)) {
+            Short (n);
+            FFD_ENSURE(n <= static_cast<size_t>(_size - _pos),
+                "FFDMemoryStream: read past the end")
+        }
+        _pos += n;
+        if (_pos >= _mark) Mark (); // it can move _p
+        return _p + _pos - n;
+    }
+    public: inline void Get(void * v, size_t n)
+    {
+        if (n > 0) OS::Memcpy (v, Take (n), n);
+    }
+    // Of the next "n" bytes, how many there are; Size() can be a bound: one
+    // still being filled waits for them first. Tell() stays.
+    public: inline size_t Have(size_t n)
+    {
+        if (_pos + static_cast<off_t>(n) >= _mark
+            || n > static_cast<size_t>(_size - _pos)) Short (n);
+        auto left = static_cast<size_t>(_size - _pos);
+        return n < left ? n : left;
+    }
+    public: inline off_t Pos() const { return _pos; }
+    public: inline const byte * Data() const { return _p; }
+
+    protected: FFDMemoryStream() {}
+    protected: const byte * _p {};
+    protected: off_t _size {}, _pos {};
+    // Mark() is called when Tell() reaches it.
+    protected: static off_t constexpr NO_MARK {
+        static_cast<off_t>(~0ull >> 1)};
+    protected: off_t _mark {NO_MARK};
+    // And when Seek() moves before this one.
+    protected: off_t _back {-1};
+    protected: virtual void Mark() {}
+    // The next "n" bytes are past _size, or _mark: one still growing or
+    // being filled makes room, or sets _size to what there is.
+    protected: virtual void Short(size_t) {}
+};// FFDMemoryStream
+
+NAMESPACE_FFD
+
+#endif
@@ -130,6 +130,14 @@ template <typename T> void Alloc(T *& p, size_t n = 1)
     if (! p)
         Exit (2);
 }
+// The new items aren't zeroed.
+template <typename T> void Realloc(T *& p, size_t n)
+{
+    FFD_ENSURE(n > 0, "n < 1")
+    p = reinterpret_cast<T *>(realloc (p, n * sizeof(T)));
+    if (! p)
+        Exit (2);
+}
 template <typename T> void Free(T * & p) { if (p) free (p), p = nullptr; }
 
 namespace __pointless_verbosity
@@ -298,6 +306,8 @@ class ByteArray// = Buffer
     private: FFD_BYTE_ARRAY_IMPL _;
 };
 
+class FFDMemoryStream;
+
 // Unlike the 3 above, this is something you pass; so extend it as you see fit.
 // All sizes and offsets are in [bytes].
 // Failure is handled by the actual IO - this one is expected to return on
@@ -305,11 +315,19 @@ class ByteArray// = Buffer
 class Stream
 {
     public: virtual Stream & Read(void *, size_t = 1) { return *this; } // bytes
+    public: virtual Stream & Write(const void *, size_t = 1) { return *this; }
     public: virtual off_t Tell() const { return 0; }
     public: virtual off_t Size() const { return 0; }
     public: virtual Stream & Seek(off_t) { return *this; } // relative - always
     // you've just been constructed
     public: virtual Stream & Reset() { return *this; }
+    // Non-null: the bytes are in memory; see "ffd_memory_stream.h".
+    public: virtual FFDMemoryStream * Memory() { return nullptr; }
+    // Optional: the next "n" bytes, at a buffer of the stream - valid until
+    // it is used again; null: it can't, Read() them. Peek() leaves Tell()
+    // as it is; Borrow() moves it past them.
+    public: virtual const byte * Peek(size_t) { return nullptr; }
+    public: virtual const byte * Borrow(size_t) { return nullptr; }
     public: Stream() {}
     public: virtual ~Stream() {}
 };
@@ -33,28 +33,292 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **** END LICENCE BLOCK ****/
 
 #include "ffd_node.h"
+#include "ffd_program.h"
+#include "ffd_memory_stream.h"
+#include "ffd_projection.h"
+#include "ffd_visitor.h"
 
 #include <new>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 FFD_NAMESPACE
-bool FFDNode::SkipAnnoyngFile{};
 
 FFDNode::~FFDNode()
 {
+    if (_arena) return; // see FFDArena::Reset()
     for (int i = 0; i < _fields.Count (); i++)
         FFD_DESTROY_OBJECT(_fields[i], FFDNode)
 }
 
+inline void FFDNode::Read(void * v, int n)
+{
+    if (_ctx->Memory) _ctx->Memory->Get (v, n);
+    else _s->Read (v, n);
+}
+
+inline off_t FFDNode::Tell() const
+{
+    return _ctx->Memory ? _ctx->Memory->Pos () : _s->Tell ();
+}
+
+inline void FFDNode::Seek(off_t ofs)
+{
+    if (_ctx->Memory) _ctx->Memory->Seek (ofs);
+    else _s->Seek (ofs);
+}
+
+inline const byte * FFDNode::Borrow(int n)
+{
+    if (_ctx->Memory) return _ctx->Memory->Take (n);
+    if (auto p = _s->Borrow (n)) return p;
+    auto p = _ctx->Scratch (n);
+    return _s->Read (p, n), p;
+}
+
+inline int FFDNode::Project(FFD::SNode * f, FFD::SNode * dt)
+{
+    if (nullptr == _ctx->Projection) return FFDProjection::ALL;
+    auto state = _ctx->Projection->Child (_ctx->ProjectionAt (_level), f, dt);
+    return _ctx->ProjectionAt (_level + 1) = state;
+}
+
+inline bool FFDNode::Unprojected() const
+{
+    return _ctx->Projection
+        && FFDProjection::NONE == _ctx->ProjectionAt (_level);
+}
+
+void FFDNode::Keep(FFDNode * f)
+{
+    if (f->Unprojected () && f->_fields.Empty ()) FFD::FreeNode (f);
+    else AddField (f);
+}
+
+inline void FFDNode::Emit(FFD::SNode * f, const byte * p, int len,
+    int count)
+{
+    if (nullptr == _ctx->Visitor) return;
+    if (count < 0) _ctx->Visitor->OnField (f, p, len);
+    else _ctx->Visitor->OnArray (f, count, p, len);
+}
+
+void FFDNode::Pass(FFD::SNode * f, FFD::SNode * dt, int n, int count)
+{
+    if (nullptr == _ctx->Visitor) { Seek (n); return; }
+    auto p = Borrow (n);
+    if (dt->Swap) { // a copy, at Scratch() - unless it is there already
+        auto q = _ctx->Scratch (n);
+        if (q != p) OS::Memcpy (q, p, n);
+        ToHostOrder (dt, q, n, _ctx), p = q;
+    }
+    Emit (f, p, n, count);
+}
+
+// The offset of the 1st "size"-byte item at "p" equal to "key" - its low
+// "size" bytes; -1: none. "n": whole items.
+static int find_item(const byte * p, int n, int key, int size)
+{
+    if (1 == size) {
+        auto f = memchr (p, key & 0xff, n);
+        return f ? static_cast<int>(static_cast<const byte *>(f) - p) : -1;
+    }
+    int i {};
+#ifdef __SSE2__
+    // 16 bytes at a time: the lanes are the items
+    auto k = 2 == size ? _mm_set1_epi16 (static_cast<short>(key))
+        : _mm_set1_epi32 (key);
+    for (; i + 16 <= n; i += 16) {
+        auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i *>(p + i));
+        int mask = _mm_movemask_epi8 (2 == size ? _mm_cmpeq_epi16 (v, k)
+            : _mm_cmpeq_epi32 (v, k));
+        if (mask) return i + __builtin_ctz (mask);
+    }
+#endif
+    unsigned int low = 2 == size ? 0xffffu : ~0u;
+    for (; i < n; i += size) {
+        unsigned int v {};
+        OS::Memcpy (&v, p + i, size);
+        if (v == (key & low)) return i;
+    }
+    return -1;
+}
+
+#ifdef __SSE2__
+// The 16 bytes at "p": the 16-bit words of each item in reverse order - the
+// _mm_shufflelo_epi16() "ORDER"; 0: they're 2-byte items - then the 2 bytes
+// of each word.
+template <int ORDER> static inline void swap_16_bytes(byte * p)
+{
+    auto q = reinterpret_cast<__m128i *>(p);
+    auto v = _mm_loadu_si128 (q);
+    if (ORDER)
+        v = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, ORDER), ORDER);
+    _mm_storeu_si128 (q, _mm_or_si128 (_mm_slli_epi16 (v, 8),
+        _mm_srli_epi16 (v, 8)));
+}
+#endif
+
+// "n" items of "size" bytes at "p": the bytes of each one in reverse order.
+static void swap_items(byte * p, int n, int size)
+{
+    int i {}, len = n * size;
+#ifdef __SSE2__
+    switch (size) {
+        case 2: for (; i + 16 <= len; i += 16) swap_16_bytes<0> (p + i);
+            break;
+        case 4: for (; i + 16 <= len; i += 16) swap_16_bytes<0xb1> (p + i);
+            break;
+        case 8: for (; i + 16 <= len; i += 16) swap_16_bytes<0x1b> (p + i);
+            break;
+    }
+#endif
+    for (; i < len; i += size) // the rest; the other sizes
+        for (int a = i, b = i + size - 1; a < b; a++, b--) {
+            auto t = p[a];
+            p[a] = p[b], p[b] = t;
+        }
+}
+
+/*static*/ void FFDNode::ToHostOrder(FFD::SNode * dt, byte * p, int len,
+    const FFD::ParseContext * ctx)
+{
+    if (! dt->IsStruct ()) { swap_items (p, len / dt->Size, dt->Size); return; }
+    // fixed-size items - see FFD::SNode::PrecomputeSize(); a field at a time
+    int size = dt->PrecomputeSize (ctx), at {};
+    FFD_ENSURE(size > 0, "byte order: not a fixed-size struct")
+    for (auto f : dt->Fields) {
+        int count = f->FixedCount (ctx), f_size = f->DType->Size;
+        if (f->DType->Swap)
+            for (int i = at; i < len; i += size)
+                swap_items (p + i, count, f_size);
+        at += count * f_size;
+    }
+}
+
+void FFDNode::ToHostOrder()
+{
+    _data.Own ();
+    ToHostOrder (_dt, _data, _data.Length (), _ctx);
+}
+
+void FFDNode::ReadUntil(int key, int size)
+{
+    auto m = _ctx->Memory;
+    // cached on purpose; - just in case. A memory one: see Have().
+    auto sa = m ? 0 : _s->Size ();
+    for (int chunk = 64; ; chunk = chunk < 1<<16 ? chunk * 2 : chunk) {
+        auto left = m ? static_cast<off_t>(m->Have (chunk)) : sa - Tell ();
+        if (left <= 0) break;
+        int n = left < chunk ? static_cast<int>(left) / size * size : chunk;
+        if (n < size) n = size; // a partial item: Read() fails, as it did
+        auto p = m ? m->Take (n) : _s->Peek (n);
+        bool peeked = p && ! m;
+        if (nullptr == p) p = Borrow (n);
+        int at = find_item (p, n, key, size);
+        int len = at < 0 ? n : at, was = _data.Length ();
+        if (len > 0)
+            _data.Resize (was + len),
+            OS::Memcpy (_data.operator byte * () + was, p, len);
+        int past = at < 0 ? n : at + size; // the key too
+        if (peeked) Seek (past);
+        else if (past < n) Seek (past - n);
+        if (at >= 0) break;
+    }
+}
+
+void FFDNode::HugeArray(FFD::SNode * f, FFD::SNode * dt, long long n,
+    int size)
+{
+    FFD_ENSURE(n <= _s->Size () - Tell (), "huge array: past the end")
+    DbgT << " ++huge array: " << static_cast<long>(n) << " bytes, at "
+        << static_cast<long>(Tell ()) << EOL;
+    if (! Unprojected ()) _lazy = HUGE_ARRAY, _at = _ctx->AddHuge (Tell (), n);
+    if (nullptr == _ctx->Visitor) { Seek (n); return; }
+    int chunk = size < HUGE_CHUNK ? HUGE_CHUNK / size * size : size;
+    for (; n > 0; n -= chunk) {
+        if (chunk > n) chunk = static_cast<int>(n);
+        Pass (f, dt, chunk, chunk / size);
+    }
+}
+
+void FFDNode::Defer(int pc, int n)
+{
+    _lazy = pc, _at = static_cast<int>(Tell ());
+    Seek (n);
+}
+
+// Where Defer() left it: the stream and FFD::ParseContext are the ones this
+// tree was built with; see FFD::ParseContext::Lazy.
+void FFDNode::Load()
+{
+    auto & op = (*_p)[_lazy];
+    _lazy = -1;
+    auto back = Tell ();
+    Seek (_at - back);
+    DbgT << "Load: " << FieldNode ()->Name << " at " << _at << EOL;
+    if (FFDProgram::OpCode::Block == op.Code) ReadData (op.A);
+    else {
+        _f->UseOnce (); _n->UseOnce ();
+        Run (_p->EntryOf (_n));
+    }
+    Seek (back - Tell ());
+}
+
+void FFDNode::ReadData(int n, bool host_order)
+{
+    if (nullptr == _ctx->Map || n <= 0) {
+        _data.Resize (n);
+        Read (_data.operator byte * (), n);
+    }
+    else _data.View (_ctx->Memory->Take (n), n);
+    if (host_order && _dt && _dt->Swap) ToHostOrder ();
+}
+
+void FFDNode::SpanData(int n, Span & span)
+{
+    if (span.Fields <= 0) return ReadData (n);
+    span.Fields--;
+    if (span.Bytes > 0) { // the 1st one: it keeps them all
+        ReadData (span.Bytes, false);
+        span.At = _data.operator byte * () + n, span.Bytes = 0;
+        _data.Resize (n);
+    }
+    else _data.View (span.At, n), span.At += n;
+    if (_dt && _dt->Swap) ToHostOrder ();
+}
+
+/*static*/ void FFDNode::DropVFIList(void * n)
+{
+    static_cast<FFDNode *>(n)->_vfi_list.~List<VFIterator> ();
+}
+
 FFDNode::FFDNode(FFD::SNode * n, Stream * br, FFDNode * base,
-    FFD::SNode * field_node)
+    FFD::SNode * field_node, const FFDProgram * program,
+    FFD::ParseContext * ctx)
     : _s{br}, _n{n}, _f{field_node}, _base{base}
 {
     if (base) _level = base->_level + 1;
+    _p = base ? base->_p : program;
+    _ctx = base ? base->_ctx : ctx;
+    FFD_ENSURE(nullptr != _ctx, "FFDNode: no ParseContext")
+    _arena = base ? base->_arena : _ctx->Arena;
+    _data.Use (_arena), _fields.Use (_arena), _slots.Use (_arena),
+        _others.Use (_arena);
 
     if (n->IsField ()) FromField ();
-    else if (n->IsStruct ()) FromStruct ();
+    else if (n->IsStruct ()) {
+        _dt = _ctx->DType (FieldNode ());
+        // the array ones: EvalArray()
+        auto v = _f && _f->Array ? nullptr : _ctx->Visitor;
+        if (v) v->OnStructBegin (FieldNode ());
+        FromStruct ();
+        if (v) v->OnStructEnd (FieldNode ());
+    }
     else
-        Dbg << "Can't handle " << n->TypeToString () << EOL;
+        DbgI << "Can't handle " << n->TypeToString () << EOL;
 }
 
 // All expressions are encolsed in ().
@@ -68,20 +332,20 @@ template <typename F> bool eval_expr(
 {
     FFD_ENSURE(id >= 0 && id < e.Count (), "Wrong expr.")
     FFDNode::ExprCtx ctx {};
-    Dbg << "  Expr: ";
+    DbgT << "  Expr: ";
     for (; id < e.Count (); id++) { // find "l op r", or "op l"
         switch (e[id].Type) {
             case FFDParser::ExprTokenType::Open: {
-                Dbg << "( ";
+                DbgT << "( ";
                 FFD_ENSURE(ctx.i < 2, "opn: Wrong number of arguments")
                 ctx.v[ctx.i++] = eval_expr (e, resolve_symbols, ++id);
             } break;
             case FFDParser::ExprTokenType::Close: {
-                Dbg << ") " << EOL;
+                DbgT << ") " << EOL;
                 return ctx.Compute ();
             }
             case FFDParser::ExprTokenType::Symbol: {
-                Dbg << "{" << e[id].Symbol << "} ";
+                DbgT << "{" << e[id].Symbol << "} ";
                 FFD_ENSURE(ctx.i < 2, "sym: Wrong number of arguments")
                 if (0 == ctx.i) ctx.LSymbol = e[id].Symbol;
                 else if (1 == ctx.i) ctx.RSymbol = e[id].Symbol;
@@ -89,7 +353,7 @@ template <typename F> bool eval_expr(
                 resolve_symbols (ctx);
             } break;
             case FFDParser::ExprTokenType::Number: {
-                Dbg << e[id].Value << " ";
+                DbgT << e[id].Value << " ";
                 FFD_ENSURE(ctx.i < 2, "num: Wrong number of arguments")
                 ctx.v[ctx.i++] = e[id].Value;
             } break;
@@ -98,20 +362,21 @@ template <typename F> bool eval_expr(
                     ctx.n[ctx.i] = true;
                 else {
                     if (2 == ctx.i) { // LR binary eval: a>b < c
-                        Dbg << "Ready to compute at id " << id;
+                        DbgT << "Ready to compute at id " << id;
                         ctx.v[0] = ctx.Compute ();
-                        Dbg << ", evaluted to " << ctx.v[0] << EOL;
+                        DbgT << ", evaluted to " << ctx.v[0] << EOL;
                         ctx.i = 1;
                         ctx.op = e[id].Type;
                         ctx.n[0] = ctx.n[1] = false;
                     }
-                    ctx.op = e[id].Type; ctx.DbgPrint ();
+                    ctx.op = e[id].Type;
+                    if (DBG_ON(FFD_DBG_TRACE)) ctx.DbgPrint ();
                 }
                 break;
             }
         }
     }
-    Dbg << EOL;
+    DbgT << EOL;
     FFD_ENSURE(1 == ctx.i, "Evaluation failed")
     return ctx.v[0];
 }// eval_expr
@@ -120,54 +385,64 @@ template <typename F> bool eval_expr(
 FFD::SNode * FFDNode::ResolveSNode(const String & n, int & value,
     FFD::SNode * sn, bool resolve_only)
 {//TODO cache me
-    Dbg << "  ResolveSNode: requested symbol: " << n << EOL;
+    DbgT << "  ResolveSNode: requested symbol: " << n << EOL;
     FFD_ENSURE(sn->IsField (), "Field SNodes only!")
-    static String sym_name {};
-    Dbg << "  ResolveSNode: sn->Base: " << sn->Base->Name << EOL;
+    auto & sym_name = _ctx->Evaluating;
+    DbgT << "  ResolveSNode: sn->Base: " << sn->Base->Name << EOL;
     for (auto sym : sn->Base->NodesByName (n)) {
-        Dbg << "  ResolveSNode: symbol: " << sym->Name << EOL;
+        DbgT << "  ResolveSNode: symbol: " << sym->Name << EOL;
         if (sym->IsConst () || sym->IsMachType () || sym->IsEnum ()) {
             FFD_ENSURE(sym_name != sym->Name, "Don't do that")
-            if (! sym->Resolved) {
-                Dbg << "  ResolveSNode: resolving ..." << EOL;
-                sym->Resolved = true;
+            if (! _ctx->Resolved (sym)) {
+                DbgT << "  ResolveSNode: resolving ..." << EOL;
+                _ctx->Resolve (sym, false);
+                bool enabled {true};
                 if (sym->Expr.Count () > 0) {
-                    Dbg << "  ResolveSNode: has an expr. evaluating ..." << EOL;
+                    DbgT << "  ResolveSNode: has an expr. evaluating ..."
+                        << EOL;
                     sym_name = sym->Name;
                     int ptr {};
-                    sym->Enabled = eval_expr (sym->Expr,
-                        [&](ExprCtx & ctx) {
-                            ResolveSymbols (ctx, sn, this);
-                        }, ptr);
+                    if (! sym->CompiledExpr || AtPSStruct ()
+                        || ! EvalExpr (*(sym->CompiledExpr), ptr, enabled)) {
+                        ptr = 0;
+                        enabled = eval_expr (sym->Expr,
+                            [&](ExprCtx & ctx) {
+                                ResolveSymbols (ctx, sn, this);
+                            }, ptr);
+                    }
                     sym_name = String {};
                 }
-                else
-                    sym->Enabled = true;
-                Dbg << "  ResolveSNode: enabled: " << sym->Enabled << EOL;
+                _ctx->Resolve (sym, enabled);
+                DbgT << "  ResolveSNode: enabled: " << enabled << EOL;
             }
             else
-                Dbg << "  ResolveSNode: resolved already" << EOL;
+                DbgT << "  ResolveSNode: resolved already" << EOL;
+            bool enabled = _ctx->Enabled (sym);
             if (resolve_only) {//LATER evaluate all and report ambiguities
-                if (! sym->Enabled) continue;
+                if (! enabled) continue;
                 else return sym; // return the 1st enabled one
             }
-            if (sym->Enabled) {//LATER detect conflicts (more than 1 enabled)
+            if (enabled) {//LATER detect conflicts (more than 1 enabled)
                 if (sym->IsIntConst ())
                     return value = sym->IntLiteral, sym;
                 else { // implicit symbol - like (bool); TODO complicates store
                     FFD_ENSURE(sym->Size >= 1 && sym->Size <= 4,
                         "Can't handle that size")
                     int avalue {};
-                    Dbg << "  ResolveSNode: implicit symbol, reading "
+                    DbgT << "  ResolveSNode: implicit symbol, reading "
                         << sym->Size << " byte" << (sym->Size > 1 ? "s" : "")
                         << EOL;
-                    _s->Read (&avalue, sym->Size);//TODO create FFDNode for it
+                    //TODO create FFDNode for it
+                    OS::Memcpy (&avalue, Borrow (sym->Size), sym->Size);
+                    if (sym->Swap)
+                        swap_items (reinterpret_cast<byte *>(&avalue), 1,
+                            sym->Size);
                     return value = avalue, sym;
                 }
             }
         }// sym->IsConst () || sym->IsMachType () || sym->IsEnum ()
     }// for (auto sym : sn->Base->NodesByName (n))
-    Dbg << "  not found at _n->Base" << EOL;
+    DbgT << "  not found at _n->Base" << EOL;
     return nullptr;
 }// FFDNode::ResolveSNode()
 
@@ -176,9 +451,9 @@ void FFDNode::ResolveSymbols(ExprCtx & ctx, FFD::SNode * sn, FFDNode * base)
 {
     //TODO this needs serious re-factoring
     //TODO match the formal spec. to the letter
-    Dbg << "   FFDNode::ResolveSymbols: ";
-    if (1 == ctx.i) Dbg << ctx.LSymbol; else Dbg << ctx.RSymbol;
-    Dbg << " for " << sn->Name << EOL;
+    DbgT << "   FFDNode::ResolveSymbols: ";
+    DbgT << (1 == ctx.i ? ctx.LSymbol : ctx.RSymbol) << " for " << sn->Name
+        << EOL;
     if (sn->Base) { // SNode
         int value {};
         bool found {};
@@ -193,21 +468,21 @@ void FFDNode::ResolveSymbols(ExprCtx & ctx, FFD::SNode * sn, FFDNode * base)
                 found = true;
             }
         if (found) {
-            Dbg << "   SNode found: L: " << ctx.v[0] << ", R: " << ctx.v[1]
+            DbgT << "   SNode found: L: " << ctx.v[0] << ", R: " << ctx.v[1]
                 << EOL;
             return;
         }
        //TODO already set? (on duplicate symbol name for example)
     }
     if (base) { // FFDNode
-        Dbg << "   FFDNode::ResolveSymbols: looking at "
+        DbgT << "   FFDNode::ResolveSymbols: looking at "
             << base->FieldNode ()->Name << EOL;
         // handle multi-depth PS field params
         bool ps_handled{}; auto ps_node = base->_base;
         while (ps_node && ! ps_handled) {
             auto snode = base->_base->FieldNode (); // synatx node
             if (snode->Parametrized ()) {
-                snode->PSDbgPrint ();
+                if (DBG_ON(FFD_DBG_TRACE)) snode->PSDbgPrint ();
                 for (int i = 0; i < snode->PS.Count (); i++)
                     if (snode->PS[i].IsField ()) {
                         if (ctx.LSymbol == snode->PS[i].Bind)
@@ -223,10 +498,10 @@ void FFDNode::ResolveSymbols(ExprCtx & ctx, FFD::SNode * sn, FFDNode * base)
             auto arr = static_cast<List<String> &&>(ctx.LSymbol.Split ('.'));
             lsym = base;
             for (int i = 0; i < arr.Count (); i++) {
-                Dbg << "NodeByName() Looking for " << arr[i] << EOL;
+                DbgT << "NodeByName() Looking for " << arr[i] << EOL;
                 lsym = lsym->NodeByName (arr[i]);
                 if (lsym)
-                    Dbg << "NodeByName() found " << arr[i] << EOL;
+                    DbgT << "NodeByName() found " << arr[i] << EOL;
                 else break;
             }
         }
@@ -237,28 +512,29 @@ void FFDNode::ResolveSymbols(ExprCtx & ctx, FFD::SNode * sn, FFDNode * base)
         if (! ctx.RSymbol.Empty () && ! rsym) // not found
             ctx.NoSymbol = true; // evaluate to false
         if (lsym && rsym) {
-            Dbg << "    lsym && rsym " << EOL;
+            DbgT << "    lsym && rsym " << EOL;
             ctx.v[0] = lsym->AsInt ();
             ctx.v[1] = rsym->AsInt ();
             return;
         }
         else if (! lsym && ! rsym) { // they could be not found
-            Dbg << "    ! lsym && ! rsym " << EOL;
+            DbgT << "    ! lsym && ! rsym " << EOL;
             return;
         }
         else if (2 == ctx.i) { // requested both; handle enum|const op symbol
             if (lsym && ! rsym) {
-                Dbg << "    lsym && ! rsym "; lsym->_n->DbgPrint ();
+                if (DBG_ON(FFD_DBG_TRACE))
+                    Dbg << "    lsym && ! rsym ", lsym->_n->DbgPrint ();
                 // check against the type set
-                if (lsym->_n->DType->IsEnum ()) {
+                if (_ctx->DType (lsym->_n)->IsEnum ()) {
                     // Dbg << "   rsym.enum: find " << ctx.RSymbol << EOL;
                     auto enum_entry =
-                        lsym->_n->DType->FindEnumItem (ctx.RSymbol);
+                        _ctx->DType (lsym->_n)->FindEnumItem (ctx.RSymbol);
                     if (enum_entry) {//TODO handle the not found part
                     ctx.v[0] = lsym->AsInt (); // already set at (1 == ctx.i)
                     ctx.v[1] = enum_entry->Value;
                     ctx.NoSymbol = false;
-                    Dbg << "   L: " << ctx.v[0] << ", R: " << ctx.v[1] << EOL;
+                    DbgT << "   L: " << ctx.v[0] << ", R: " << ctx.v[1] << EOL;
                     return;
                     }
                     else
@@ -268,17 +544,18 @@ void FFDNode::ResolveSymbols(ExprCtx & ctx, FFD::SNode * sn, FFDNode * base)
                 return;
             }//TODO handle the reverse: if (! lsym && rsym)
             else {//LATER swapping requires index swapping at ctx.v as well
-                Dbg << "    ! lsym && rsym "; rsym->_n->DbgPrint ();
+                if (DBG_ON(FFD_DBG_TRACE))
+                    Dbg << "    ! lsym && rsym ", rsym->_n->DbgPrint ();
                 // check against the type set
-                if (rsym->_n->DType->IsEnum ()) {
+                if (_ctx->DType (rsym->_n)->IsEnum ()) {
                     // Dbg << "   rsym.enum: find " << ctx.RSymbol << EOL;
                     auto enum_entry =
-                        rsym->_n->DType->FindEnumItem (ctx.RSymbol);
+                        _ctx->DType (rsym->_n)->FindEnumItem (ctx.RSymbol);
                     if (enum_entry) {//TODO handle the not found part
                     ctx.v[0] = enum_entry->Value;
                     ctx.v[1] = rsym->AsInt (); // already set at (1 == ctx.i)
                     ctx.NoSymbol = false;
-                    Dbg << "   L: " << ctx.v[0] << ", R: " << ctx.v[1] << EOL;
+                    DbgT << "   L: " << ctx.v[0] << ", R: " << ctx.v[1] << EOL;
                     return;
                     }
                     else
@@ -289,41 +566,151 @@ void FFDNode::ResolveSymbols(ExprCtx & ctx, FFD::SNode * sn, FFDNode * base)
             }
         }
         else if (1 == ctx.i) {
-            Dbg << "    lookup for 1 symbol: ";
+            DbgT << "    lookup for 1 symbol: ";
             if (lsym) {
-                Dbg << " left: ";
+                DbgT << " left: ";
                 ctx.v[0] = lsym->AsInt ();
-                Dbg << ctx.v[0] << EOL;
+                DbgT << ctx.v[0] << EOL;
                 ctx.NoSymbol = false;
                 return;
             }
             if (rsym) {
-                Dbg << " right: ";
+                DbgT << " right: ";
                 ctx.v[1] = rsym->AsInt ();
-                Dbg << ctx.v[1] << EOL;
+                DbgT << ctx.v[1] << EOL;
                 ctx.NoSymbol = false;
                 return;
             }
             FFD_ENSURE(0, "1 == ctx.i && ! l && ! r ?!")
         }
-        Dbg << "  not found at _base" << EOL;
+        DbgT << "  not found at _base" << EOL;
     }// if (_base)
 }// FFDNode::ResolveSymbol
 
+// Same as ResolveSymbols() above, for FFDExpr: the root-level lookup is
+// done already; the PS renaming is not supported.
+bool FFDNode::ResolveSymbols(ExprCtxOf<const FFDExpr::Symbol *> & ctx)
+{
+    bool found {};
+    if (ctx.LSymbol && ctx.LSymbol->Const)
+        ctx.v[0] = ctx.LSymbol->Value, found = true;
+    if (ctx.RSymbol && ctx.RSymbol->Const)
+        ctx.v[1] = ctx.RSymbol->Value, found = true;
+    if (found) return true;
+
+    FFDNode * lsym {}, * rsym {};
+    if (ctx.LSymbol) {
+        lsym = this;
+        for (auto id : ctx.LSymbol->PathIds)
+            if (! (lsym = lsym->NodeByName (id))) break;
+    }
+    if (ctx.RSymbol) rsym = NodeByName (ctx.RSymbol->NameId);
+    if ((ctx.LSymbol && ! lsym) || (ctx.RSymbol && ! rsym))
+        ctx.NoSymbol = true;
+    if (lsym && rsym) {
+        ctx.v[0] = lsym->AsInt ();
+        ctx.v[1] = rsym->AsInt ();
+    }
+    else if (! lsym && ! rsym) return true;
+    else if (2 == ctx.i) {
+        if (lsym) {
+            auto dt = _ctx->DType (lsym->_n);
+            if (nullptr == dt) return false;
+            if (dt->IsEnum ()) {
+                if (dt == ctx.RSymbol->Enum)
+                    ctx.v[1] = ctx.RSymbol->EnumValue;
+                else {
+                    auto enum_entry = dt->FindEnumItem (ctx.RSymbol->Name);
+                    if (! enum_entry) return false;
+                    ctx.v[1] = enum_entry->Value;
+                }
+            }
+            ctx.v[0] = lsym->AsInt (); ctx.NoSymbol = false;
+        }
+        else {
+            auto dt = _ctx->DType (rsym->_n);
+            if (nullptr == dt || dt->IsEnum ()) return false;
+            ctx.v[1] = rsym->AsInt (); ctx.NoSymbol = false;
+        }
+    }
+    else if (1 == ctx.i) {
+        if (lsym) ctx.v[0] = lsym->AsInt ();
+        else ctx.v[1] = rsym->AsInt ();
+        ctx.NoSymbol = false;
+    }
+    return true;
+}// FFDNode::ResolveSymbols()
+
+// Same as eval_expr() above, for FFDExpr.
+bool FFDNode::EvalExpr(const FFDExpr & e, int & id, bool & result)
+{
+    FFD_ENSURE(id >= 0 && id < e.Count (), "Wrong expr.")
+    ExprCtxOf<const FFDExpr::Symbol *> ctx {};
+    for (; id < e.Count (); id++) {
+        auto & step = e[id];
+        switch (step.Type) {
+            case FFDParser::ExprTokenType::Open: {
+                FFD_ENSURE(ctx.i < 2, "opn: Wrong number of arguments")
+                bool v {};
+                if (! EvalExpr (e, ++id, v)) return false;
+                ctx.v[ctx.i++] = v;
+            } break;
+            case FFDParser::ExprTokenType::Close:
+                return result = ctx.Compute (), true;
+            case FFDParser::ExprTokenType::Symbol: {
+                FFD_ENSURE(ctx.i < 2, "sym: Wrong number of arguments")
+                if (0 == ctx.i) ctx.LSymbol = &(e.SymbolAt (step.Symbol));
+                else if (1 == ctx.i)
+                    ctx.RSymbol = &(e.SymbolAt (step.Symbol));
+                ctx.i++;
+                if (! ResolveSymbols (ctx)) return false;
+            } break;
+            case FFDParser::ExprTokenType::Number: {
+                FFD_ENSURE(ctx.i < 2, "num: Wrong number of arguments")
+                ctx.v[ctx.i++] = step.Value;
+            } break;
+            default: {
+                if (FFDParser::ExprTokenType::opN == step.Type)
+                    ctx.n[ctx.i] = true;
+                else {
+                    if (2 == ctx.i) { // LR binary eval: a>b < c
+                        ctx.v[0] = ctx.Compute ();
+                        ctx.i = 1;
+                        ctx.n[0] = ctx.n[1] = false;
+                    }
+                    ctx.op = step.Type;
+                }
+            } break;
+        }
+    }
+    FFD_ENSURE(1 == ctx.i, "Evaluation failed")
+    return result = ctx.v[0], true;
+}// FFDNode::EvalExpr()
+
 bool FFDNode::EvalBoolExpr(FFD::SNode * sn, FFDNode * base)
 {
-    Dbg << "FFDNode::EvalBoolExpr(" << sn->Name << ", "
+    DbgT << "FFDNode::EvalBoolExpr(" << sn->Name << ", "
         << base->FieldNode ()->Name << ")" << EOL;
+    if (sn->CompiledExpr && ! base->AtPSStruct ()) {
+        int id {};
+        bool result {};
+        if (base->EvalExpr (*(sn->CompiledExpr), id, result)) {
+            DbgT << "   FFD::Node::EvalBoolExpr: " << result << " (compiled)"
+                << EOL;
+            return result;
+        }
+    }
     int ptr {};
     auto result = eval_expr (sn->Expr, [&](ExprCtx & ctx) {
         ResolveSymbols (ctx, sn, base);
     }, ptr);
-    Dbg << "   FFD::Node::EvalBoolExpr: " << result << EOL;
+    DbgT << "   FFD::Node::EvalBoolExpr: " << result << EOL;
     return result;
 }
 
 String FFDNode::AsString()
 {
+    Need ();
     return static_cast<String &&>(String {_data, _data.Length ()});
 }
 
@@ -332,20 +719,24 @@ void FFDNode::EvalArray()
     _array = true;
     // given "Foo bar[]", _f is "bar" and _n is "Foo"; (_n = _f->DType)
     auto n = nullptr != _f ? _f : _n;
-    Dbg << " +field, array of " << n->DType->Name << EOL;
+    auto dt = _ctx->DType (n);
+    DbgT << " +field, array of " << dt->Name << EOL;
     // array size
-    int arr_size {}, final_size {1};
+    int arr_size {};
+    long long final_size {1}; // items, then bytes; see HugeArray()
     bool ja {false};
     for (int i = 0; i < FFD_MAX_ARR_DIMS; i++) {
         if (n->Arr[i].None ()) break;
         FFD_ENSURE(! ja, "implement me: jagged array of jagged arrays")
-        Dbg << " ++dim type: "; n->Arr[i].DbgPrint (); Dbg << EOL;
+        int jagged {-1};
+        if (DBG_ON(FFD_DBG_TRACE))
+            Dbg << " ++dim type: ", n->Arr[i].DbgPrint (), Dbg << EOL;
         // Is it an implicit machine type?
         if (! n->Arr[i].Name.Empty ()) { // [{symbol}]
             // Look at root; because there are no root arrays - the array is
             // a field in a struct (n->Base (and n->Base is a node in a DLL)).
             // Dbg << " ++dim Looking for " << n->Arr[i].Name << EOL;
-            auto m = n->Base->NodeByName (n->Arr[i].Name);
+            auto m = n->Base->NodeByName (n->Arr[i].Name, _ctx);
             // Dbg << " ++dim still Looking for " << n->Arr[i].Name << EOL;
             if (! m) {
                 int value {};
@@ -356,22 +747,24 @@ void FFDNode::EvalArray()
                 // Dbg << " ++dim still2 Looking for " << n->Arr[i].Name << EOL;
             }
             if (m && m->IsIntConst ()) { // [FOO_CONST]
-                _arr_dim[i] = m;
-                Dbg << " ++dim value (intconst): " << m->IntLiteral << " items"
+                DbgT << " ++dim value (intconst): " << m->IntLiteral << " items"
                     << EOL;
                 arr_size = m->IntLiteral;
             }
             else if (m && ! m->IsMachType () && ! m->IsEnum ()) {
-                Dbg << " implement me: root SNode array dim; jagged arr for "
+                DbgI << " implement me: root SNode array dim; jagged arr for "
                     "example" << EOL;
                 return;
             }
             else if (m) {// a "type" found at root; [int] or [byte] ...
-                _arr_dim[i] = m;
-                Dbg << " ++dim size (implicit): " << m->Size << " bytes" << EOL;
+                DbgT << " ++dim size (implicit): " << m->Size << " bytes"
+                    << EOL;
                 FFD_ENSURE(m->Size >= 0 && m->Size <= 4, "array dim overflow")
-                _s->Read (&arr_size, m->Size);
-                Dbg << " ++dim value (implicit): " << arr_size << " items"
+                OS::Memcpy (&arr_size, Borrow (m->Size), m->Size);
+                if (m->Swap)
+                    swap_items (reinterpret_cast<byte *>(&arr_size), 1,
+                        m->Size);
+                DbgT << " ++dim value (implicit): " << arr_size << " items"
                     << EOL;
             }
             else { // not a root SNode; no point searching at Fields
@@ -380,13 +773,13 @@ void FFDNode::EvalArray()
                 if (nullptr == node && AtPSStruct ()) {
                     auto p = _base->FieldNode ()->PSParamByName (n->Arr[i].Name);
                     if (p) {
-                        Dbg << "PS: array dim is an instance field" << EOL;
+                        DbgT << "PS: array dim is an instance field" << EOL;
                         auto tmp = _base->_base;
                         while (tmp) {
                             auto b = tmp->FieldNode ()->PSParamByBind (p->Name);
                             if (b) {
-                                Dbg << "Found \"" << p->Name << "\" bound to \""
-                                    << b->Name << "\"" EOL;
+                                DbgT << "Found \"" << p->Name
+                                    << "\" bound to \"" << b->Name << "\"" EOL;
                                 node = NodeByName (b->Name);//TODO repl. Arr[i]?
                                 break;
                             }
@@ -397,99 +790,125 @@ void FFDNode::EvalArray()
                 FFD_ENSURE(nullptr != node, "Arr. dim. not found")
                 if (node->_array) {
                     ja = true;
-                    Dbg << "[j] item size: " << node->_array_item_size << EOL;
+                    DbgT << "[j] item size: " << node->_array_item_size << EOL;
                     arr_size = 1, final_size = node->IntArrElementSum ();
-                    Dbg << "[j] total items: " << arr_size << EOL;
+                    jagged = static_cast<int>(final_size);
+                    DbgT << "[j] total items: " << arr_size << EOL;
                 }
                 else {
                 FFD_ENSURE(node->_n->IsField (), "Unsupported arr. dim.")
-                m = node->_n->DType;
+                m = _ctx->DType (node->_n);
                 FFD_ENSURE(m->IsValidArrDim (), "Unsupported arr. dim.")
                 FFD_ENSURE(m->Size >= 0 && m->Size <= 4, "Arr. dim. overflow")
                 arr_size = node->AsInt ();
-                Dbg << " ++dim size (ffdnode): " << arr_size << " items" << EOL;
+                DbgT << " ++dim size (ffdnode): " << arr_size << " items"
+                    << EOL;
                 }
             }
         }// ! n->Arr[i].Name.Empty ()
         else if (n->Arr[i].Value < 0) { // "-key" - read until "key"
             FFD_ENSURE(0 == i, "multi-dim read-until arrays not supported yet")
-            FFD_ENSURE(n->DType->IsMachType () || n->DType->IsEnum (),
+            FFD_ENSURE(dt->IsMachType () || dt->IsEnum (),
                 "negative array size")
-            FFD_ENSURE(1 == n->DType->Size || 2 == n->DType->Size
-                || 4 == n->DType->Size, "read-until: unsupported item size")
+            FFD_ENSURE(1 == dt->Size || 2 == dt->Size
+                || 4 == dt->Size, "read-until: unsupported item size")
             int key = -n->Arr[i].Value;
-            Dbg << " ++dim read until \"" << key << "\"" << EOL;
-            auto sa = _s->Size (); // cached on purpose; - just in case
-            for (int b = key; _s->Tell () < sa;) { //TODO optimize me
-                _s->Read (&b, n->DType->Size);
-                if (b == key) break;
-                _data.Resize (_data.Length () + n->DType->Size);
-                OS::Memcpy(_data.operator byte * () + _data.Length () -
-                    n->DType->Size, &b, n->DType->Size);
-            }
-            Dbg << " ++dim read until len: " << _data.Length () << EOL;
-            String preview {_data.operator byte * (), _data.Length ()};
-            Dbg << " ++dim read until as text: " << preview << EOL;
+            DbgT << " ++dim read until \"" << key << "\"" << EOL;
+            if (dt->Swap) // as it is at the file
+                swap_items (reinterpret_cast<byte *>(&key), 1, dt->Size);
+            ReadUntil (key, dt->Size);
+            if (dt->Swap) ToHostOrder ();
+            DbgT << " ++dim read until len: " << _data.Length () << EOL;
+            DbgT << " ++dim read until as text: "
+                << String {_data.operator byte * (), _data.Length ()} << EOL;
             //TODO [][-key], [-key][], [-key][-key]
         }
         else {
-            Dbg << " ++dim value (intlit): " << n->Arr[i].Value << " items"
+            DbgT << " ++dim value (intlit): " << n->Arr[i].Value << " items"
                 << EOL;
-            _arr_dim[i] = n;
             arr_size = n->Arr[i].Value;
         }
         final_size *= arr_size;
+        // read-until: the items it has read; jagged: all of its items
+        _arr_dim[i] = n->Arr[i].Value < 0 ? _data.Length () / dt->Size
+            : jagged >= 0 ? jagged : arr_size;
+        // 3 dimensions of int: in range while the 1st two are
+        FFD_ENSURE(final_size >= -(1ll<<40) && final_size <= 1ll<<40,
+            "suspicious array size 0")
     }
-    Dbg << " ++array size: " << final_size << EOL;
+    DbgT << " ++array size: " << static_cast<long>(final_size) << EOL;
     if (0 == final_size) { // An actual use-case: "Atlantis_1029662174.h3m".
+        Emit (n, _data, _data.Length (),
+            _data.Length () > 0 ? _data.Length () / dt->Size : 0);
         if (0 == _data.Length ())
-            Dbg << "Warning: array final_size of 0: nothing to read" << EOL;
+            DbgI << "Warning: array final_size of 0: nothing to read" << EOL;
         return;
     }
     // Valid file value: NiPixelData.PNum 00 00 55 00 - I mean: come on
-    FFD_ENSURE(final_size >= 0 && final_size <= 1<<23,
+    FFD_ENSURE(final_size >= 0
+        && (final_size <= 1<<23 || _ctx->HugeArrays > 0),
         "suspicious array size 1")
     // item size
     _array_item_size = 0;
-    if (n->DType->IsMachType () || n->DType->IsEnum ()) {
-        Dbg << " ++item size: " << n->DType->Size << " bytes" << EOL;
-        final_size *= (_array_item_size = n->DType->Size);
-        FFD_ENSURE(final_size >= 0 && final_size <= 1<<23,
-            "suspicious array size 2")
-        _data.Resize (final_size);
-        _s->Read (_data.operator byte * (), final_size);
-        Dbg << " ++data: "; PrintByteSequence ();
+    if (dt->IsMachType () || dt->IsEnum ()) {
+        DbgT << " ++item size: " << dt->Size << " bytes" << EOL;
+        final_size *= (_array_item_size = dt->Size);
+        if (final_size > 1<<23) {
+            FFD_ENSURE(final_size <= _ctx->HugeArrays,
+                "suspicious array size 2")
+            HugeArray (n, dt, final_size, dt->Size);
+            return;
+        }
+        int len = static_cast<int>(final_size);
+        if (Unprojected ()) {
+            Pass (n, dt, len, len / dt->Size);
+            return;
+        }
+        ReadData (len);
+        Emit (n, _data, len, len / dt->Size);
+        if (DBG_ON(FFD_DBG_TRACE)) Dbg << " ++data: ", PrintByteSequence ();
         //TODO HasAttribute() while n->Base->Prev && n->Base->Prev->IsAttribute()
         if (n->Base->Prev && n->Base->Prev->IsAttribute () &&
             n->Base->Prev->Attribute == "[Text]")
-            Dbg << " ++text: " << AsString () << EOL;
+            DbgT << " ++text: " << AsString () << EOL;
     }
     else {// array item
-        int psize = n->DType->PrecomputeSize (); n->DType->UseOnce ();
+        int psize = dt->PrecomputeSize (_ctx); dt->UseOnce ();
         if (psize > 0) { // 41472 TTile for example
-            Dbg << " ++item pre-computed size: " << psize << " bytes" << EOL;
+            DbgT << " ++item pre-computed size: " << psize << " bytes" << EOL;
             final_size *= (_array_item_size = psize);
-            FFD_ENSURE(final_size >= 0 && final_size <= 1<<21,
-                "suspicious array size 3")
+            if (final_size > 1<<21) {
+                FFD_ENSURE(final_size <= _ctx->HugeArrays,
+                    "suspicious array size 3")
+                HugeArray (n, dt, final_size, psize);
+                return;
+            }
             // read once
-            _data.Resize (final_size);
-            _s->Read (_data.operator byte * (), final_size);
-            //LATER accessing those is complicated:
-            //       - I have to provide n-dim access
-            //       - it has to know it is at _data, not at _fields
-            //       - it has to keep psize and all arr. dim. sizes; that would
-            //         be simple, save for jagged arrays
+            int len = static_cast<int>(final_size);
+            if (Unprojected ()) Pass (n, dt, len, len / psize);
+            else ReadData (len), Emit (n, _data, len, len / psize);
+            // the items: see FFDStructArray
         }
         else {// array struct item
+            FFD_ENSURE(final_size <= 1<<23, "suspicious array size 1")
+            if (_ctx->Projection) { // the items: as the array
+                auto state = _ctx->ProjectionAt (_level);
+                _ctx->ProjectionAt (_level + 1) = state;
+            }
+            Emit (n, nullptr, 0, static_cast<int>(final_size));
             for (int i = 0 ; i < final_size; i++) {
-                Dbg << " +++item [" << i << "] (dynamic)" << EOL;
+                DbgT << " +++item [" << i << "] (dynamic)" << EOL;
                 // These are unconditional because there is no per-array item,
                 // boolean evaluation. A.k.a. - the entire array is present.
                 FFDNode * f {};
-                Dbg << "ArrayField of " << _n->Name
+                DbgT << "ArrayField of " << _n->Name
                     << " named " << _f->Name << EOL;
-                FFD_CREATE_OBJECT(f, FFDNode) {_n, _s, this};
-                _fields.Add (f);
+                if (_ctx->Visitor && Unprojected ()) { // see FFDVisitor
+                    FFDNode item {_n, _s, this};
+                    continue;
+                }
+                f = Create (_arena, _n, _s, this);
+                Keep (f);
             }
         }
     }
@@ -497,40 +916,46 @@ void FFDNode::EvalArray()
 
 void FFDNode::FromField()
 {
-    Dbg << " field " << _n->Name << EOL;
-    if (! _n->DType) {
+    DbgT << " field " << _n->Name << EOL;
+    auto data_type = _ctx->DType (_n);
+    if (! data_type) {
         int unused {};
         bool resolve_only {true};
-        Dbg << " Resolving " << _n->DTypeName << EOL;
-        _n->DType = ResolveSNode (_n->DTypeName, unused, _n, resolve_only);
+        DbgT << " Resolving " << _n->DTypeName << EOL;
+        data_type = ResolveSNode (_n->DTypeName, unused, _n, resolve_only);
+        _ctx->SetDType (_n, data_type);
     }
-    FFD_ENSURE(nullptr != _n->DType, "field->DType can't be null")
-    _n->UseOnce (); _n->DType->UseOnce ();
-
-    auto data_type = _n->DType; data_type->UseOnce ();
+    FFD_ENSURE(nullptr != data_type, "field->DType can't be null")
+    _n->UseOnce (); data_type->UseOnce ();
+    _dt = data_type;
     FFD_ENSURE(data_type->IsMachType () || data_type->IsEnum (),
         "bug: FFDNode::FromStruct() passed a field with unhandled DType")
     if (_n->Array)
         EvalArray ();
     else {
-        Dbg << " field, data size: " << data_type->Size << " bytes" << EOL;
+        DbgT << " field, data size: " << data_type->Size << " bytes" << EOL;
         FFD_ENSURE(data_type->Size >= 0
             && data_type->Size <= FFD_MAX_MACHTYPE_SIZE, "data_type->Size")
-        _data.Resize (data_type->Size);
         _signed = data_type->Signed;
-        _s->Read (_data.operator byte * (), data_type->Size);
-        Dbg << " field, data: "; PrintByteSequence ();
-        if ("UVersion2" == _n->Name && AsInt () == 100)//TODO shouldn't be here
-            { FFDNode::SkipAnnoyngFile = true; return; }
+        if (Unprojected ()) {
+            Pass (_n, data_type, data_type->Size, -1);
+            return;
+        }
+        ReadData (data_type->Size);
+        Emit (_n, _data, _data.Length (), -1);
+        if (DBG_ON(FFD_DBG_TRACE))
+            Dbg << " field, data: ", PrintByteSequence ();
+        if (_n->StopsParsing () && AsInt () == FFD::SNode::STOP_VALUE)
+            { _ctx->Skip = true; return; }
         // HashKey
         if (_n->HashKey) {
             _hk = true;
-            Dbg << " field, hk; looking for ttype: " << _n->HashType << EOL;
+            DbgT << " field, hk; looking for ttype: " << _n->HashType << EOL;
             _ht = FindHashTable (_n->HashType);
             FFD_ENSURE(nullptr != _ht, "Hash table not found")
             auto ht_fn = _ht->FieldNode ();
             auto ht_base_fn = _ht->_base->FieldNode ();
-            Dbg << " field, hk, table: " << ht_base_fn->Name << "."
+            DbgT << " field, hk, table: " << ht_base_fn->Name << "."
                 << ht_fn->Name << EOL;
         }
     }
@@ -542,123 +967,272 @@ void FFDNode::FromStruct(FFD::SNode * sn)
     if (! sn) sn = _n; // temporary: allows for the recursive detour below
 
     //TODO really, remove that recursive nice-mountain-view
-    if (_f) { Dbg << " field " << _f->Name << " "; _f->UseOnce (); }
-    Dbg << "struct lvl " << _level << ": "  << sn->Name << EOL;
+    if (_f) { DbgT << " field " << _f->Name << " "; _f->UseOnce (); }
+    DbgT << "struct lvl " << _level << ": "  << sn->Name << EOL;
     if (! don_use_f && _f && _f->Array) {
         // "Foo bar[]" that has already passed the eval below
         EvalArray ();
         return;
     }
 
-    sn->UseOnce (); _n->UseOnce (); for (auto n : sn->Fields) {
-        FFDNode * f {};
-        Dbg << "<> " << sn->Name << "." << n->Name
-            << Dbg.Fmt (" offset: %000000008X", _s->Tell ()) << EOL;
-        if (n->HasExpr () && ! EvalBoolExpr (n, this)) {
-            Dbg << " Eval: false: " << n->Name << EOL;
-            continue; //TODO disable its attributes too
+    sn->UseOnce (); _n->UseOnce ();
+    // The parametrized ones are resolved per instance - by the tree-walk.
+    if (_p && ! FieldNode ()->Parametrized ()) {
+        auto pc = _p->EntryOf (sn);
+        if (pc >= 0) { Run (pc); return; }
+    }
+    for (auto n : sn->Fields)
+        if (! FromStructField (sn, n)) return;
+}// FFD::Node::FromStruct()
+
+// The key of "... a.b.c": walk the names; hash keys resolve to their item.
+FFDNode * FFDNode::VariadicKey(const List<String> & names)
+{
+    FFDNode * fn{this}; //TODO this code repeats at Resolve above
+    for (int i = 0; i < names.Count (); i++) { // ... hk.field
+        fn = fn->NodeByName (names[i]);
+        FFD_ENSURE(nullptr != fn, "  ++var: unk. field.")
+        if (fn->_hk) {
+            DbgT << "  ++var: Hash(" << fn->AsInt (fn->_ht) << ")"
+                << EOL;
+            fn = fn->_ht->Hash (fn);
+            FFD_ENSURE(nullptr != fn, "  ++var: unk. obj.")
+            FFD_ENSURE(fn->_base->_array, "  ++var: not-arr. obj.")
+            DbgT << "  ++var: obj[" << i << "]: ."
+                << fn->_base->FieldNode ()->Name << EOL;
         }
-        n->UseOnce ();
-        //TODO this is a temporary workaround until A<Foo> and A<Bar> become
-        //     two separate root syntax nodes; ditto for any number of params:
-        //     "mangling"; sync to the "if (n->Composite)" TODO below
-        if (/*! n->DType && */FieldNode ()->Parametrized ()) {
+        else
+            DbgT << "  ++var: obj[" << i << "]: ."
+                << fn->FieldNode ()->Name << EOL;
+    }
+    return fn;
+}// FFDNode::VariadicKey()
+
+// One field "n" of struct "sn". Returns false when there shall be no more
+// fields.
+bool FFDNode::FromStructField(FFD::SNode * sn, FFD::SNode * n)
+{
+    FFDNode * f {};
+    DbgT << "<> " << sn->Name << "." << n->Name
+        << Dbg.Fmt (" offset: %000000008X", _s->Tell ()) << EOL;
+    if (n->HasExpr () && ! EvalBoolExpr (n, this)) {
+        DbgT << " Eval: false: " << n->Name << EOL;
+        return true; //TODO disable its attributes too
+    }
+    n->UseOnce ();
+    //TODO this is a temporary workaround until A<Foo> and A<Bar> become
+    //     two separate root syntax nodes; ditto for any number of params:
+    //     "mangling"; sync to the "if (n->Composite)" TODO below
+    if (/*! n->DType && */FieldNode ()->Parametrized ()) {
+        if (DBG_ON(FFD_DBG_TRACE)) {
             Dbg << "<><> FieldNode: "; FieldNode ()->DbgPrint ();
             Dbg << "<><> Resolving parametrized " << n->DTypeName << EOL;
             Dbg << "<><> FieldNodePS: "; FieldNode ()->PSDbgPrint ();
-            auto base{this};
-            while (base) {
-                auto p = base->FieldNode ()->PSParamBy ([&](auto & pp) {
-                    return pp.IsType () && pp.Bind == n->DTypeName; });
-                if (p) {
-                    n->DType = n->Base->NodeByName (p->Name);
-                    if (nullptr != n->DType) {
-                        Dbg << "<><> Found parametrized " << p->Name << EOL;
-                        break;
-                    }
+        }
+        auto base{this};
+        FFD::SNode * ps_type {};
+        while (base) {
+            auto p = base->FieldNode ()->PSParamBy ([&](auto & pp) {
+                return pp.IsType () && pp.Bind == n->DTypeName; });
+            if (p) {
+                ps_type = n->Base->NodeByName (p->Name, _ctx);
+                if (nullptr != ps_type) {
+                    DbgT << "<><> Found parametrized " << p->Name << EOL;
+                    break;
                 }
-                base = base->_base;
             }
-            FFD_ENSURE(nullptr != n->DType, "Create the parametrized DType")
+            base = base->_base;
         }
-        if (n->DType && n->DType->IsStruct ()) {
-            if (n->Composite && ! n->Parametrized ()) {//TODO composite && ps
-                Dbg << "Composite struct: " << n->DType->Name << EOL;
-                //TODO do this at the FFDParser, otherwise one and the same
-                //     syntax node could get modified more than once - not ok
-                FromStruct (n->DType);
-                continue;
-            }
-            else
-                FFD_CREATE_OBJECT(f, FFDNode) {n->DType, _s, this, n};
+        FFD_ENSURE(nullptr != ps_type, "Create the parametrized DType")
+        _ctx->SetDType (n, ps_type);
+    }
+    auto dt = _ctx->DType (n);
+    if (dt && dt->IsStruct ()) {
+        if (n->Composite && ! n->Parametrized ()) {//TODO composite && ps
+            DbgT << "Composite struct: " << dt->Name << EOL;
+            //TODO do this at the FFDParser, otherwise one and the same
+            //     syntax node could get modified more than once - not ok
+            FromStruct (dt);
+            return true;
+        }
+        else if (FFDProjection::NONE == Project (n, dt) && _ctx->Visitor) {
+            FFDNode tmp {dt, _s, this, n}; // see FFDVisitor
+            return ! _ctx->Skip;
         }
-        else {//TODO to functions
-            if (n->Variadic) {
-                Dbg << "Variadic field; - a dynamic composite field" << EOL;
-                Dbg << "  ++var Dynamic Name: " << n->Name << EOL;
-                List<String> names =
-                    static_cast<List<String> &&> (n->Name.Split ('.'));
+        else
+            f = Create (_arena, dt, _s, this, n);
+    }
+    else {//TODO to functions
+        if (n->Variadic) {
+            DbgT << "Variadic field; - a dynamic composite field" << EOL;
+            DbgT << "  ++var Dynamic Name: " << n->Name << EOL;
+            List<String> names =
+                static_cast<List<String> &&> (n->Name.Split ('.'));
+            if (DBG_ON(FFD_DBG_TRACE))
                 for (int i = 0; i < names.Count (); i++)
                     Dbg << "  ++var: name[" << i << "]: " << names[i] << EOL;
-                FFD_ENSURE(names.Count () > 0, "  ++var: key not found.")
-                // end of String::Split ('.');
-                FFDNode * fn{this}; //TODO this code repeats at Resolve above
-                if (FFD_STRUCT_BY_NAME == names[0]) { // ... hash.hkeys
-                    List<FFDNode *> ht {}; // TODO allow ht[0] == fn ?
-                    for (int i = 1; i < names.Count (); i++) {
-                        fn = fn->NodeByName (names[i]);
-                        FFD_ENSURE(nullptr != fn, "  ++var: unk. ht.")
-                        if (i < names.Count ()-1) // the last one can be non-arr
-                            FFD_ENSURE(fn->_array, "  ++var: non-array ht.")
-                        ht.Add (fn);
-                    }
-                    //TODO what if _base->_base is the array, etc. refactor
-                    //     to handle tree iterator
-                    FFD_ENSURE(_base->_array, "can't iterate over non-array")
-                    if (_base->_vfi_list.Empty ())//TODO see GetVFIterator
-                        _base->_vfi_list.Add (VFIterator {ht});
-                    auto em_node = FieldNode ()->NodeByName (
-                        _base->_vfi_list[0].ResolveToString (&ht));
-                    FFD_ENSURE(em_node != nullptr, "  ++var: not found")
-                    Dbg <<  "  ++var: em_node: "; em_node->DbgPrint ();
-                    FromStruct (em_node);
-                    continue;
-                }// if (FFD_STRUCT_BY_NAME == names[0])
-                for (int i = 0; i < names.Count (); i++) { // ... hk.field
+            FFD_ENSURE(names.Count () > 0, "  ++var: key not found.")
+            // end of String::Split ('.');
+            FFDNode * fn{this}; //TODO this code repeats at Resolve above
+            if (FFD_STRUCT_BY_NAME == names[0]) { // ... hash.hkeys
+                List<FFDNode *> ht {}; // TODO allow ht[0] == fn ?
+                for (int i = 1; i < names.Count (); i++) {
                     fn = fn->NodeByName (names[i]);
-                    FFD_ENSURE(nullptr != fn, "  ++var: unk. field.")
-                    if (fn->_hk) {
-                        Dbg << "  ++var: Hash(" << fn->AsInt (fn->_ht) << ")"
-                            << EOL;
-                        fn = fn->_ht->Hash (fn);
-                        FFD_ENSURE(nullptr != fn, "  ++var: unk. obj.")
-                        FFD_ENSURE(fn->_base->_array, "  ++var: not-arr. obj.")
-                        Dbg << "  ++var: obj[" << i << "]: ."
-                            << fn->_base->FieldNode ()->Name << EOL;
-                    }
-                    else
-                        Dbg << "  ++var: obj[" << i << "]: ."
-                            << fn->FieldNode ()->Name << EOL;
+                    FFD_ENSURE(nullptr != fn, "  ++var: unk. ht.")
+                    if (i < names.Count ()-1) // the last one can be non-arr
+                        FFD_ENSURE(fn->_array, "  ++var: non-array ht.")
+                    ht.Add (fn);
                 }
-                Dbg << "  ++var: value-list value: " << fn->AsInt () << EOL;
-                auto composite = sn->FindVListItem (n->Name, fn->AsInt ());
-                // It is allowed to be not found: no more fields.
-                if (composite) {
-                    Dbg << "composite: " << composite->Name;
-                        composite->PrintValueList ();
-                    //TODO Emit new Syntax node here: sn->Name + n->Name
-                    //     + fn->AsInt (fn->_ht); or sn->Name.Autoinc;
-                    //     some distinct name to avoid modifying one and the
-                    //     same thing
-                    FromStruct (composite);
+                //TODO what if _base->_base is the array, etc. refactor
+                //     to handle tree iterator
+                FFD_ENSURE(_base->_array, "can't iterate over non-array")
+                if (_base->_vfi_list.Empty ()) {//TODO see GetVFIterator
+                    // not the FFDVisitor ones, on the stack: their dtor
+                    // drops it
+                    if (_base->_arena && _base->_arena->Owns (_base))
+                        _base->_arena->AtReset (DropVFIList, _base);
+                    _base->_vfi_list.Add (VFIterator {ht});
                 }
-                continue;
-            }// (n->Variadic)
-            else
-                FFD_CREATE_OBJECT(f, FFDNode) {n, _s, this};
-        }// ! (n->DType && n->DType->IsStruct ())
-        _fields.Add (f); if (FFDNode::SkipAnnoyngFile) return;
+                auto em_node = FieldNode ()->NodeByName (
+                    _base->_vfi_list[0].ResolveToString (&ht), _ctx);
+                FFD_ENSURE(em_node != nullptr, "  ++var: not found")
+                if (DBG_ON(FFD_DBG_TRACE))
+                    Dbg <<  "  ++var: em_node: ", em_node->DbgPrint ();
+                FromStruct (em_node);
+                return true;
+            }// if (FFD_STRUCT_BY_NAME == names[0])
+            fn = VariadicKey (names);
+            DbgT << "  ++var: value-list value: " << fn->AsInt () << EOL;
+            auto composite = sn->FindVListItem (n->Name, fn->AsInt (), _ctx);
+            // It is allowed to be not found: no more fields.
+            if (composite) {
+                if (DBG_ON(FFD_DBG_TRACE))
+                    Dbg << "composite: " << composite->Name,
+                    composite->PrintValueList ();
+                //TODO Emit new Syntax node here: sn->Name + n->Name
+                //     + fn->AsInt (fn->_ht); or sn->Name.Autoinc;
+                //     some distinct name to avoid modifying one and the
+                //     same thing
+                FromStruct (composite);
+            }
+            return true;
+        }// (n->Variadic)
+        else {
+            auto state = Project (n, dt);
+            // Projection: a scalar of known size - no FFDNode for it
+            if (FFDProjection::NONE == state && dt && ! n->Array
+                && (dt->IsMachType () || dt->IsEnum ()) && dt->Size >= 0
+                && dt->Size <= FFD_MAX_MACHTYPE_SIZE) {
+                Pass (n, dt, dt->Size, -1);
+                return true;
+            }
+            if (FFDProjection::NONE == state && _ctx->Visitor) {
+                FFDNode tmp {n, _s, this}; // see FFDVisitor
+                return ! _ctx->Skip;
+            }
+            f = Create (_arena, n, _s, this);
+        }
+    }// ! (dt && dt->IsStruct ())
+    Keep (f);
+    return ! _ctx->Skip;
+}// FFDNode::FromStructField()
+
+// Same tree as the FromStructField() loop; see FFDProgram for the ops.
+void FFDNode::Run(int pc)
+{
+    using OC = FFDProgram::OpCode;
+    Span span {};
+    for (;; pc++) {
+        auto & op = (*_p)[pc];
+        switch (op.Code) {
+            case OC::End: return;
+            case OC::Span: // lazy, projection: some fields are skipped
+                if (op.B > 1 && ! _ctx->Lazy && (! _ctx->Projection
+                    || FFDProjection::ALL == _ctx->ProjectionAt (_level)))
+                    span = Span {nullptr, op.A, op.B};
+                break;
+            case OC::Branch:
+                if (! EvalBoolExpr (op.Field, this)) {
+                    DbgT << " Eval: false: " << op.Field->Name << EOL;
+                    pc += op.A;
+                } break;
+            case OC::Use: op.Field->UseOnce (); op.Type->UseOnce (); break;
+            case OC::Scalar: {
+                op.Field->UseOnce (); op.Type->UseOnce ();
+                if (FFDProjection::NONE == Project (op.Field, op.Type)) {
+                    Pass (op.Field, op.Type, op.Type->Size, -1);
+                    break;
+                }
+                auto f = NewChild (op.Field, nullptr, op.Type);
+                f->_signed = op.Type->Signed;
+                f->SpanData (op.Type->Size, span);
+                Emit (op.Field, f->_data, f->_data.Length (), -1);
+                AddField (f);
+            } break;
+            case OC::Block: {// EvalArray(), known sizes
+                op.Field->UseOnce (); op.Type->UseOnce ();
+                if (FFDProjection::NONE == Project (op.Field, op.Type)) {
+                    Pass (op.Field, op.Type, op.A, op.A / op.B);
+                    break;
+                }
+                auto f = op.Type->IsStruct ()
+                    ? NewChild (op.Type, op.Field, op.Type)
+                    : NewChild (op.Field, nullptr, op.Type);
+                f->_array = true;
+                f->_array_item_size = op.B;
+                for (int i = 0; i < FFD_MAX_ARR_DIMS; i++)
+                    f->_arr_dim[i] = op.Dim[i];
+                if (_ctx->Lazy && ! _ctx->Map && Tell () < (1u<<31) - op.A)
+                    f->Defer (pc, op.A);
+                else
+                    f->SpanData (op.A, span),
+                    Emit (op.Field, f->_data, op.A, op.A / op.B);
+                AddField (f);
+            } break;
+            case OC::Struct: {
+                FFDNode * f {};
+                auto dt = _ctx->DType (op.Field);
+                // fixed-layout: see FFDProgram
+                auto state = Project (op.Field, dt);
+                if (FFDProjection::NONE == state && _ctx->Visitor) {
+                    op.Field->UseOnce ();
+                    FFDNode tmp {op.Type, _s, this, op.Field}; // FFDVisitor
+                    if (_ctx->Skip) pc = op.B - 1;
+                    break;
+                }
+                if (FFDProjection::NONE == state && op.A > 0) {
+                    op.Field->UseOnce ();
+                    Seek (op.A);
+                    break;
+                }
+                if (_ctx->Lazy && op.A > 0 && Tell () < (1u<<31) - op.A) {
+                    f = NewChild (op.Type, op.Field, dt);
+                    f->Defer (pc, op.A);
+                    AddField (f);
+                    break;
+                }
+                op.Field->UseOnce ();
+                f = Create (_arena, op.Type, _s, this, op.Field);
+                Keep (f);
+                if (_ctx->Skip) pc = op.B - 1;
+            } break;
+            case OC::Variadic: {
+                op.Field->UseOnce ();
+                int key = VariadicKey (_p->Names (op.A))->AsInt ();
+                DbgT << "  ++var: value-list value: " << key << EOL;
+                // It is allowed to be not found: no more fields.
+                for (auto c : _p->Candidates (op.A))
+                    if (c->Usable (_ctx) && c->InValueList (key)) {
+                        FromStruct (c);
+                        break;
+                    }
+            } break;
+            case OC::Field:
+                if (! FromStructField (op.Struct, op.Field)) pc = op.B - 1;
+                break;
+            default: FFD_ENSURE(0, "FFDNode::Run(): unknown op")
+        }
     }
-}// FFD::Node::FromStruct()
+}// FFDNode::Run()
 
 NAMESPACE_FFD
@@ -39,15 +39,29 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ffd_model.h"
 #include "ffd.h"
+#include "ffd_expr.h"
+#include "ffd_arena.h"
+
+#include <new>
 
 FFD_NAMESPACE
 
+class FFDProgram;
+class FFDTable;
+
 // File Format Description.
 // This is the tree that your data gets transformed to, by the description.
 // FFDNode = f (SNode, Stream)
 class FFD_EXPORT FFDNode
 {
-    private: ByteArray _data {}; // empty for _array == true; _fields has them
+    friend class FFDTable; // flattens it
+    friend class FFDArrayCursor; // reads the huge ones
+    friend class FFDStructArray; // views the fixed-size struct ones
+    friend class FFDArrayView; // views the multi-dimensional ones
+    // From FFD::ParseContext::Arena when there is one: so are _data, _fields
+    // and the FFDNode-s at _fields; they're freed by FFDArena::Reset().
+    private: FFDArena * _arena {};
+    private: ArenaArray<byte> _data {}; // empty for _array; _fields has them
     private: Stream * _s {}; // reference
     private: FFD::SNode * _n {}; // reference ; node
     private: FFD::SNode * _f {}; // reference ; field node (Foo _f[])
@@ -55,23 +69,146 @@ class FFD_EXPORT FFDNode
     private: bool _array {}; // array of struct at _fields
     private: int _array_item_size {}; // array of struct at _data
     private: bool _hk {}; // hash key
-    private: FFD::SNode * _arr_dim[3] {}; // references; store the dimensions
+    // FFD::ParseContext::Lazy: the Struct or Block op this one is yet to be
+    // read by; -1: it has been. _at: where, at _s. HUGE_ARRAY: _at is the
+    // FFD::ParseContext::Huge() one.
+    private: int _lazy {-1};
+    private: static int constexpr HUGE_ARRAY {-2};
+    // _array: the items per dimension, the outermost 1st; see FFDArrayView
+    private: int _arr_dim[FFD_MAX_ARR_DIMS] {};
     // No point making it an LL:
     //  - twice the number of objects created
     //  - considerable slow down of the Hash() access below
     //  - doesn't resolve the recursive situation at FromStruct()
     //  - doesn't resolve the odd (for me) mem. leaks; one thing is sure: it
     //    ain't caused by the List<T>
-    private: List<FFDNode *> _fields {};
+    private: ArenaArray<FFDNode *> _fields {};
+    // By FFD::SNode::Slot of _n: 1 + the index at _fields of the 1st field
+    // of that name; 0: none yet. NodeByName() looks at these, not at the
+    // nodes. Not for _array.
+    private: ArenaArray<int> _slots {};
+    // The indices at _fields of the fields that aren't of _n: composite and
+    // variadic ones; they're looked at one by one.
+    private: ArenaArray<int> _others {};
+    private: inline void AddField(FFDNode * f)
+    {
+        _fields.Add (f);
+        if (_array) return;
+        auto fn = f->FieldNode ();
+        if (fn->Base != _n || fn->Slot < 0) {
+            _others.Add (_fields.Count () - 1);
+            return;
+        }
+        if (_slots.Empty ()) _slots.Resize (_n->SlotCount);
+        if (! _slots[fn->Slot]) _slots[fn->Slot] = _fields.Count ();
+    }
     private: int _level {};
+    private: int _at {};
     private: FFDNode * _base {};
     private: FFDNode * _ht {}; // hash table - referred by a hash key node
+    private: const FFDProgram * _p {}; // reference; null: walk the SNode-s
+    // reference; valid while the tree is being built, just like _s
+    private: FFD::ParseContext * _ctx {};
+    // FieldNode ()->DType at this input; the description one could be null or
+    // another one, see FFD::ParseContext
+    private: FFD::SNode * _dt {};
     // node, stream, base_node, field_node (has DType and Array: responsible for
-    // "node" processing)
+    // "node" processing), program and context (used when there is no
+    // base_node)
     public: FFDNode(FFD::SNode *, Stream *, FFDNode * base = nullptr,
-        FFD::SNode * = nullptr);
+        FFD::SNode * = nullptr, const FFDProgram * = nullptr,
+        FFD::ParseContext * = nullptr);
+    // An empty one; FFDNode::Run() fills it.
+    private: FFDNode(FFDNode * base, FFD::SNode * n, FFD::SNode * f,
+        FFD::SNode * dt)
+        : _arena{base->_arena}, _s{base->_s}, _n{n}, _f{f},
+        _level{base->_level + 1}, _base{base}, _p{base->_p},
+        _ctx{base->_ctx}, _dt{dt}
+    {
+        _data.Use (_arena), _fields.Use (_arena), _slots.Use (_arena),
+            _others.Use (_arena);
+    }
+    // FFD_CREATE_OBJECT, or placement new at "arena".
+    public: template <typename... A> static inline FFDNode * Create(
+        FFDArena * arena, A... a)
+    {
+        FFDNode * n {};
+        if (arena) n = new (arena->Alloc (sizeof(FFDNode))) FFDNode {a...};
+        else FFD_CREATE_OBJECT(n, FFDNode) {a...};
+        return n;
+    }
+    private: inline FFDNode * NewChild(FFD::SNode * n, FFD::SNode * f,
+        FFD::SNode * dt)
+    {
+        return Create (_arena, this, n, f, dt);
+    }
+    private: static void DropVFIList(void *);
+    // "n" bytes of the stream to _data: a view into FFD::ParseContext::Map
+    // when there is one; a copy otherwise.
+    // Stream::Read(); FFDMemoryStream::Get() when the stream is one.
+    private: inline void Read(void *, int);
+    private: inline off_t Tell() const;
+    private: inline void Seek(off_t);
+    // The next "n" bytes: where they are - FFDMemoryStream::Take(),
+    // Stream::Borrow() - or read to FFD::ParseContext::Scratch(). Valid
+    // until the stream is used again.
+    private: inline const byte * Borrow(int n);
+    // Lazy: skip "n" bytes; Load() reads them with op "pc" when needed.
+    private: void Defer(int pc, int n);
+    private: void Load();
+    private: inline void Need() const
+    {
+        if (_lazy >= 0) const_cast<FFDNode *>(this)->Load ();
+    }
+    // "host_order": ToHostOrder() them, when _dt is to be swapped.
+    private: void ReadData(int n, bool host_order = true);
+    // FFD::SNode::Swap: "len" bytes at "p" - items of "dt": a machine type,
+    // an enum, or a fixed-size struct - to the host byte order, in place.
+    private: static void ToHostOrder(FFD::SNode * dt, byte * p, int len,
+        const FFD::ParseContext *);
+    // The one of _data; a View() is copied first.
+    private: void ToHostOrder();
+    // EvalArray(): "[-key]" - the "size"-byte items before "key", to _data;
+    // a chunk at a time - Take(), or Stream::Peek() and Seek() past the key;
+    // Read() and Seek() back when the stream can't.
+    private: void ReadUntil(int key, int size);
+    // EvalArray(): "n" bytes of array "f" - of "dt", "size" each - over the
+    // "suspicious array size" limit: left at the stream; see
+    // FFD::ParseContext::HugeArrays. The Visitor gets them HUGE_CHUNK at a
+    // time.
+    private: void HugeArray(FFD::SNode * f, FFD::SNode * dt, long long n,
+        int size);
+    private: static int constexpr HUGE_CHUNK {1<<20}; // [bytes]
+    // FFD::ParseContext::Projection: the state of field "f" - "dt" its
+    // DType - about to be built at the level below; see FFDProjection.
+    private: inline int Project(FFD::SNode * f, FFD::SNode * dt);
+    // Projection: not on a path, and not what the data depend on; this one
+    // is being built.
+    private: inline bool Unprojected() const;
+    // Adds "f" to _fields; drops it when it is Unprojected() and empty.
+    private: void Keep(FFDNode * f);
+    // FFD::ParseContext::Visitor: field "f" - "len" bytes at "p", "count"
+    // items; -1: not an array.
+    private: inline void Emit(FFD::SNode * f, const byte * p, int len,
+        int count);
+    // Unprojected(): "n" bytes of field "f" - of "dt" - to the Visitor, or
+    // skipped.
+    private: void Pass(FFD::SNode * f, FFD::SNode * dt, int n, int count);
+    // Run(): the fields after a Span op - one ReadData() for all of them.
+    // The 1st field keeps the bytes; the data of the others are views.
+    private: struct Span final
+    {
+        const byte * At; // the next field's data
+        int Bytes;       // to read, at the 1st field
+        int Fields;      // left
+    };
+    private: void SpanData(int n, Span &);
     private: void FromStruct(FFD::SNode * = nullptr);
+    private: bool FromStructField(FFD::SNode * sn, FFD::SNode * n);
+    private: FFDNode * VariadicKey(const List<String> & names);
     private: void FromField();
+    // Run the compiled struct, starting at "pc".
+    private: void Run(int pc);
     public: ~FFDNode();
 
     // FFDNode Converter - used by the Get() method.
@@ -124,19 +261,26 @@ class FFD_EXPORT FFDNode
         if (nullptr == node) return dt;
         return NodeCon<T> {node}.operator T ();
     }
+    // Ditto, at NodeByPath().
+    public: template <typename T> T Get(const FFD::Path & path, T dt = T {})
+    {
+        auto node = NodeByPath (path);
+        if (nullptr == node) return dt;
+        return NodeCon<T> {node}.operator T ();
+    }
 
     public: inline bool IsEnum() const
     {
         auto sn = FieldNode ();
         FFD_ENSURE(nullptr != sn, "No syntax node")
         //TODO what instance nodes are allowed to have no type info?
-        FFD_ENSURE(nullptr != sn->DType, "No type info")
-        return sn->DType->IsEnum ();
+        FFD_ENSURE(nullptr != _dt, "No type info")
+        return _dt->IsEnum ();
     }
     public: inline const String & GetEnumName() const
     {
         int v = AsInt ();
-        auto itm = FieldNode ()->DType->EnumItems.Find (
+        auto itm = _dt->EnumItems.Find (
             [&v](const auto & itm) { return itm.Value == v; });
         FFD_ENSURE(nullptr != itm, "Unknown enum value")
         return itm->Name;
@@ -147,6 +291,7 @@ class FFD_EXPORT FFDNode
     private: inline FFDNode * Hash(const FFDNode * key) const
     {
         FFD_ENSURE(nullptr != key, "Hash(): key can't be null")
+        Need ();
         // auto sn = key->FieldNode ();
         if (_data.Length () > 0) {
             //LATER either construct a new FFDNode to just use its AsInt() -
@@ -163,32 +308,37 @@ class FFD_EXPORT FFDNode
             FFD_ENSURE(0, "Implement me: int hash(key)")
         }
         else if (_fields.Count () > 0) {
-            Dbg << "key->AsInt: " << key->AsInt (key->_ht) << "/"
+            DbgT << "key->AsInt: " << key->AsInt (key->_ht) << "/"
                 << _fields.Count () << EOL;
             return _fields[key->AsInt (key->_ht)];
         }
         else
             FFD_ENSURE(0, "Empty HashTable")
     }
-    public: inline byte AsByte() const { return _data[0]; }
+    public: inline byte AsByte() const { return Need (), _data[0]; }
     public: inline short AsShort() const
     {
+        Need ();
         switch (_data.Length ())
         {
             case 1:
                 return static_cast<short>(*(_data.operator byte * ()));
-            case 2: return
-                *(reinterpret_cast<short *>(_data.operator byte * ()));
+            case 2: return As<short> ();
             default: FFD_ENSURE(0, "Don't request that AsShort")
         }
     }
+    // _data can be a view into a mapped file: no alignment.
     public: template <typename T> inline T As() const
     {
-        return *(reinterpret_cast<T *>(_data.operator byte * ()));
+        T result;
+        Need ();
+        memcpy (&result, _data.operator byte * (), sizeof(T));
+        return result;
     }
     public: inline int AsInt(FFDNode * ht = nullptr) const
     {
         int result {};
+        Need ();
         switch (_data.Length ())
         {
             case 1: result = static_cast<int>(As<byte> ()); break;
@@ -199,24 +349,39 @@ class FFD_EXPORT FFDNode
         }
         if ((_hk && ! ht) || (ht && ht != _ht)) {//TODO test-me
             FFD_ENSURE(nullptr != _ht, "HashKey without a HashTable")
-            auto sn = _ht->FieldNode ();
-            FFD_ENSURE(sn->DType->IsIntType (), "HashTable<not int>")
+            FFD_ENSURE(_ht->_dt->IsIntType (), "HashTable<not int>")
             result = _ht->Hash (this)->AsInt ();
         }
         return result;
     }
+    // A view at an offset T can't be read at - a file mapping, a Span - is
+    // copied first: the pointer is T-aligned.
     public: template <typename T> inline const T * AsArr() const
     {
+        Need ();
+        if (reinterpret_cast<uintptr_t>(_data.operator byte * ())
+            % alignof(T) && _data.IsView ())
+            const_cast<FFDNode *>(this)->_data.Own ();
         return reinterpret_cast<T *>(_data.operator byte * ());
     }
+    // Item "i" of an array of T at _data; see As().
+    public: template <typename T> inline T ArrAt(int i) const
+    {
+        T result;
+        Need ();
+        memcpy (&result, _data.operator byte * () + i * sizeof(T), sizeof(T));
+        return result;
+    }
 
-    struct ExprCtx final // required to evaluate enum elements in expression.
+    // Required to evaluate enum elements in expression.
+    // S: String - the symbol name; const FFDExpr::Symbol * - see FFDExpr.
+    template <typename S> struct ExprCtxOf final
     {
         int v[2] {}; // l r
         int i {};    // 0 1
         bool n[2] {}; // negate for l r
-        String LSymbol {}; // Version | RoE
-        String RSymbol {}; // RoE     | Version
+        S LSymbol {}; // Version | RoE
+        S RSymbol {}; // RoE     | Version
         FFDParser::ExprTokenType op {FFDParser::ExprTokenType::None}; // Binary
         bool NoSymbol {};
         public: inline int Compute()
@@ -258,7 +423,8 @@ class FFD_EXPORT FFDNode
                 default: Dbg << "?? "; break;
             }
         }
-    };// ExprCtx
+    };// ExprCtxOf
+    using ExprCtx = ExprCtxOf<String>;
     // Evaluate machtype|enum Size, or const IntLiteral, based on their Expr.
     // Cache their Enabled state, based on the evaluated Expr.
     // Returns the SNode of the symbol that was found.
@@ -272,6 +438,11 @@ class FFD_EXPORT FFDNode
     private: void ResolveSymbols(ExprCtx &, FFD::SNode * sn, FFDNode * base);
     // sn - expression node, base - current struct node
     private: bool EvalBoolExpr(FFD::SNode * sn, FFDNode * base);
+    // The FFDExpr variant of eval_expr() and ResolveSymbols(), at "this" -
+    // the current struct node. Returns false when "e" needs something only
+    // those can do; nothing has been read from the stream by then.
+    private: bool EvalExpr(const FFDExpr & e, int & id, bool & result);
+    private: bool ResolveSymbols(ExprCtxOf<const FFDExpr::Symbol *> &);
     private: void EvalArray();
 
     // [dbg]
@@ -289,37 +460,86 @@ class FFD_EXPORT FFDNode
     }
     public: inline FFD::SNode * FieldNode() const { return _f ? _f : _n; }
     public: inline FFDNode * NodeByName(const String & name)
+    {
+        return NodeByName (NameId (name));
+    }
+    // For NodeByName(int): look it up once, use it on many nodes of the same
+    // description. -1: no node of it is named so.
+    public: inline int NameId(const String & name) const
+    {
+        auto names = FieldNode ()->Names;
+        return names ? names->IndexOf (name) : -1;
+    }
+    // By FFD::SNode::NameId; -1: none of the nodes is named so.
+    public: inline FFDNode * NodeByName(int name_id)
     {
         //LATER
         // This lookup is not quite ok. Duplicate symbol names might surprise
         // one. I better think of some way to explicitly mark "public" symbols.
+        if (name_id < 0) return nullptr;
         if (_array) { // no point looking in it
-            if (_base) return _base->NodeByName (name);
+            if (_base) return _base->NodeByName (name_id);
             return nullptr;
         }
 
-        for (auto n : _fields) {
-            auto sn = n->FieldNode ();
-            if (sn->Name == name) return n;
-        }
+        auto n = FieldByName (name_id);
+        if (n) return n;
 
-        if (_base) return _base->NodeByName (name);
+        if (_base) return _base->NodeByName (name_id);
 
         return nullptr;
     }
+    // Not at the base nodes - not _array.
+    // O(1) unless there are _others: the 1st one added, as if all of _fields
+    // were looked at.
+    private: inline FFDNode * FieldByName(int name_id)
+    {
+        Need ();
+        int i {-1};
+        if (! _slots.Empty ()) {
+            auto slot = _n->SlotOf (name_id);
+            if (slot >= 0) i = _slots[slot] - 1;
+        }
+        for (auto j : _others)
+            if ((i < 0 || j < i) && _fields[j]->FieldNode ()->NameId == name_id)
+                { i = j; break; }
+        return i < 0 ? nullptr : _fields[i];
+    }
+    // At the root node: the one FFD::File2Tree() returned. Null when the
+    // data don't have it: a field disabled by its expression, an index out
+    // of range, or an array with no FFDNode per item - see ArrayOfFields().
+    public: inline FFDNode * NodeByPath(const FFD::Path & path)
+    {
+        FFD_ENSURE(nullptr == _base, "NodeByPath: at the root node")
+        FFD_ENSURE(path._names == FieldNode ()->Names,
+            "NodeByPath: a path of another FFD")
+        FFDNode * n {this};
+        for (auto & step : path._steps) {
+            if (n->_array) return nullptr;
+            n = n->FieldByName (step.NameId);
+            if (nullptr == n) return nullptr;
+            if (step.Index < 0) continue;
+            n->Need ();
+            if (! n->ArrayOfFields () || step.Index >= n->_fields.Count ())
+                return nullptr;
+            n = n->_fields[step.Index];
+        }
+        return n;
+    }
     public: inline FFDNode * FindHashTable(const String & type_name)
     {
         if (_array) { // no point looking in it
             if (_base) return _base->FindHashTable (type_name);
             return nullptr;
         }
+        Need ();
         for (auto n : _fields) {
             auto sn = n->FieldNode ();
             /*Dbg << " field: " << sn->Name << ", type: "
                 << (sn->DType ? sn->DType->Name : "none")
                 << ", arr. dims: " << sn->ArrDims () << EOL;*/
             if (1 == sn->ArrDims ()
-                && sn->DType && sn->DType->Name == type_name) return n;
+                && n->_dt && n->_dt->Name == type_name) return n;
         }
         if (_base) return _base->FindHashTable (type_name);
         return nullptr;
@@ -327,6 +547,7 @@ class FFD_EXPORT FFDNode
 
     public: inline void PrintTree(int f_id = -1)
     {
+        Need ();
         for (int i = 0; i < _level; i++) {
             if (_level-1 == i) {
                 if (_base && _base->_fields.Count () - 1 == f_id) Dbg << "'-";
@@ -352,6 +573,7 @@ class FFD_EXPORT FFDNode
 
     public: inline int TotalNodeCount() const
     {
+        Need ();
         int cnt {_fields.Count ()};
         for (auto node : _fields) cnt += node->TotalNodeCount ();
         return cnt;
@@ -361,33 +583,45 @@ class FFD_EXPORT FFDNode
     {
         return _array && 0 == _array_item_size;
     }
+    // Left at the stream, for it is too large: see FFDArrayCursor; its
+    // data are empty.
+    public: inline bool IsHuge() const { return HUGE_ARRAY == _lazy; }
     public: inline int NodeCount() const
     {
+        Need ();
         return ArrayOfFields () ? _fields.Count ()
             : _data.Length () / _array_item_size;
     };
     public: inline FFDNode * operator[](int i)
     {
-        //LATER create unconditional FFDNode from memory stream;
-        //      sync with SNode::PrecomputeSize()
-        FFD_ENSURE(ArrayOfFields (), "Pre-computed size, not implemented yet")
+        Need ();
+        // the fixed-size struct items have no FFDNode: see FFDStructArray
+        FFD_ENSURE(ArrayOfFields (), "Pre-computed size: see FFDStructArray")
         return _fields[i];
     }
-    public: inline List<FFDNode *> & Nodes() { return _fields; }
+    public: inline ArenaArray<FFDNode *> & Nodes()
+    {
+        return Need (), _fields;
+    }
 
-    public: inline const ByteArray * AsByteArray() { return &_data; }
+    public: inline const ArenaArray<byte> * AsByteArray()
+    {
+        return Need (), &_data;
+    }
+    // Allocated from an FFDArena: FFD::FreeNode() leaves it to the arena.
+    public: inline bool InArena() const { return nullptr != _arena; }
 
     public: inline int IntArrElementAt(int index)
     {
-        auto dt = FieldNode ()->DType;
+        auto dt = _dt;
         FFD_ENSURE(dt != nullptr, "IntArrElementAt: DType can't be null")
         FFD_ENSURE(dt->IsIntType (), "IntArrElementAt: not an int array")
         switch (dt->Size) {//TODO <size: size_t, signed: bool> to Type
-            case 1: return AsArr<byte> ()[index];
-            case 2: return dt->Signed ? AsArr<short> ()[index]
-                : AsArr<unsigned short> ()[index];
-            case 4: return dt->Signed ? AsArr<int>()[index]
-                : AsArr<unsigned int>()[index];
+            case 1: return ArrAt<byte> (index);
+            case 2: return dt->Signed ? ArrAt<short> (index)
+                : ArrAt<unsigned short> (index);
+            case 4: return dt->Signed ? ArrAt<int> (index)
+                : static_cast<int>(ArrAt<unsigned int> (index));
             default: FFD_ENSURE(0, "IntArrElementAt: unhandled DType->Size")
         }
     }
@@ -399,19 +633,27 @@ class FFD_EXPORT FFDNode
             ;
         return r;
     }
+    // By ArrAt(): AsArr() would copy a misaligned view.
+    public: template<typename T> inline int ArrSum(int n) const
+    {
+        int r{};
+        for (int i = 0; i < n; r+=static_cast<int>(ArrAt<T> (i++)))
+            ;
+        return r;
+    }
     public: inline int IntArrElementSum() //TODO Arr API
     {
-        auto dt = FieldNode ()->DType;
+        auto dt = _dt;
         FFD_ENSURE(dt != nullptr, "IntArrElementSum: DType can't be null")
         FFD_ENSURE(dt->IsIntType (), "IntArrElementSum: not an int array")
         switch (dt->Size) {//TODO <size: size_t, signed: bool> to Type
-            case 1: return AASum (AsArr<byte> (), NodeCount ());
+            case 1: return ArrSum<byte> (NodeCount ());
             case 2: return dt->Signed
-                ? AASum (AsArr<short> (), NodeCount ())
-                : AASum (AsArr<unsigned short> (), NodeCount ());
+                ? ArrSum<short> (NodeCount ())
+                : ArrSum<unsigned short> (NodeCount ());
             case 4: return dt->Signed
-                ? AASum (AsArr<int>(), NodeCount ())
-                : AASum (AsArr<unsigned int>(), NodeCount ());
+                ? ArrSum<int> (NodeCount ())
+                : ArrSum<unsigned int> (NodeCount ());
             default: FFD_ENSURE(0, "IntArrElementSum: unhandled DType->Size")
         }
     }
@@ -427,12 +669,14 @@ class FFD_EXPORT FFDNode
             // "field"
             FFD_ENSURE(Ht.Count () > 0 && Ht.Count () < 3,
                 "VFIterator: odd number of nodes")
-            Dbg << "VFIterator: Table(s):" << EOL;
-            for (int i = 0; i < Ht.Count (); i++) {
-                Dbg << "  ht[" << i << "]: "
-                    << Ht[i]->FieldNode ()->Base->Name << "."
-                    << Ht[i]->FieldNode ()->Name << EOL << "  ";
-                    Ht[i]->FieldNode ()->DbgPrint ();
+            if (DBG_ON(FFD_DBG_TRACE)) {
+                Dbg << "VFIterator: Table(s):" << EOL;
+                for (int i = 0; i < Ht.Count (); i++) {
+                    Dbg << "  ht[" << i << "]: "
+                        << Ht[i]->FieldNode ()->Base->Name << "."
+                        << Ht[i]->FieldNode ()->Name << EOL << "  ";
+                        Ht[i]->FieldNode ()->DbgPrint ();
+                }
             }
             if (1 == n.Count ()) { // 1 node that directly resolves to string
                 //TODO
@@ -441,12 +685,12 @@ class FFD_EXPORT FFDNode
                 //  ... struct.Name <- is this the correct syntax?
                 //  ... Name <- looks more appropriate
                 // what happens if it is a non-local array of strings?
-                Dbg << "VFIterator: single field" << EOL;
+                DbgT << "VFIterator: single field" << EOL;
                 return;
             }
             // 0 -> ... struct.isnt_an_array (1 == Ht.Count ())
             Count = Ht.Count () > 1 ? Ht[1]->NodeCount () : 0;
-            Dbg << "VFIterator: ltop layer keys: " << Count << EOL;
+            DbgT << "VFIterator: ltop layer keys: " << Count << EOL;
         }
         int Index{}; //
         int Count{}; // Ht[1]->Count
@@ -455,14 +699,15 @@ class FFD_EXPORT FFDNode
                               // 2. Ht[0]->AsString()
         inline String ResolveToString(List<FFDNode *> * update = nullptr)
         {
-            Dbg << "VFIterator: ResolveToString" <<  Ht.Count () << EOL;
+            DbgT << "VFIterator: ResolveToString" <<  Ht.Count () << EOL;
             if (1 == Ht.Count ()) { // this becomes a template?!
                 //TODO clarify the ??-iterator situation: names, over what
                 //     it is being iterated, are not in a pre-defined array;
                 //     a.k.a. the iterator is building the array
                 if (update) Ht[0] = update->operator[] (0);
-                Dbg << "VFIterator: val: " << Ht[0]->_fields[0]->AsString ()
-                    << " at Index: " << Index++ << EOL;
+                DbgT << "VFIterator: val: " << Ht[0]->_fields[0]->AsString ()
+                    << " at Index: " << Index << EOL;
+                Index++;
                 return Ht[0]->_fields[0]->AsString ();
             }
             else {
@@ -474,7 +719,7 @@ class FFD_EXPORT FFDNode
                     "VFI: key out of range")
                 FFD_ENSURE(Ht[0]->_fields[key]->_fields.Count () > 0,
                     "VFI: odd hash item")
-                Dbg << "VFIterator: key: " << key << ", " << "val: "
+                DbgT << "VFIterator: key: " << key << ", " << "val: "
                     << Ht[0]->_fields[key]->_fields[0]->AsString ()
                     << " at Index: " << Index-1 << EOL;
                 return Ht[0]->_fields[key]->_fields[0]->AsString ();
@@ -488,7 +733,6 @@ class FFD_EXPORT FFDNode
     {
         return _base && _base->FieldNode ()->Parametrized ();
     }
-    public: static __attribute__ ((visibility("default"))) bool SkipAnnoyngFile;
 };// FFDNode
 
 NAMESPACE_FFD
@@ -321,19 +321,19 @@ void FFDParser::SkipCommentWhitespaceSequence()
 List<FFDParser::VLItem> FFDParser::ReadValueList()
 {
     List<FFDParser::VLItem> result {};
-    Dbg << "val-list: ";
+    DbgD << "val-list: ";
     bool a {};
     for (;; a = true) {
         FFDParser::VLItem itm {};
         itm.A = ParseIntLiteral ();
-        if (a) Dbg << ", ";
+        if (a) DbgD << ", ";
         if ('-' == _buf[_i]) {
             _i++;
             FFD_ENSURE_LFFD(HasMoreData (), "Incomplete val-list") // -EOF
-            itm.B = ParseIntLiteral (); Dbg << itm.A << "-" << itm.B;
+            itm.B = ParseIntLiteral (); DbgD << itm.A << "-" << itm.B;
         }
         else {
-            itm.B = itm.A; Dbg << itm.A;
+            itm.B = itm.A; DbgD << itm.A;
         }
         FFD_ENSURE_LFFD(itm.A <= itm.B, "Wrong val-list: a can't be > b")
         result.Add (itm);
@@ -342,7 +342,7 @@ List<FFDParser::VLItem> FFDParser::ReadValueList()
             FFD_ENSURE_LFFD(HasMoreData (), "Incomplete val-list") // ,EOF
         }
     }
-    Dbg << EOL;
+    DbgD << EOL;
     return static_cast<List<FFDParser::VLItem> &&>(result);
 }
 
@@ -383,44 +383,44 @@ FFDParser::ExprTokenType FFDParser::TokenizeExpressionOp()
             switch (_buf[_i+1]) {
                 case '=' :
                     FFD_ENSURE_LFFD(is_line_whitespace (_buf[_i+2]), "Wrong Op")
-                    Dbg << "!= "; return _i+=2, ExprTokenType::opNE;
-                case '(' : Dbg << "! "; return ++_i, ExprTokenType::opN;
+                    DbgD << "!= "; return _i+=2, ExprTokenType::opNE;
+                case '(' : DbgD << "! "; return ++_i, ExprTokenType::opN;
                 default:
                     FFD_ENSURE_LFFD(SymbolValid1st (_buf[_i+1]), "Wrong Op");
-                    Dbg << "! "; return ++_i, ExprTokenType::opN;
+                    DbgD << "! "; return ++_i, ExprTokenType::opN;
             }
         case '<':
             if (is_line_whitespace (_buf[_i+1]))
-                return ++_i, Dbg << "< ", ExprTokenType::opL;
+                return ++_i, DbgD << "< ", ExprTokenType::opL;
             FFD_ENSURE_LFFD('=' == _buf[_i+1], "Wrong Op")
             FFD_ENSURE_LFFD(is_line_whitespace (_buf[_i+2]), "Wrong Op")
-            Dbg << "<= ";
+            DbgD << "<= ";
             return _i+=2, ExprTokenType::opLE;
         case '>':
             if (is_line_whitespace (_buf[_i+1]))
-                return ++_i, Dbg << "> ", ExprTokenType::opG;
+                return ++_i, DbgD << "> ", ExprTokenType::opG;
             FFD_ENSURE_LFFD('=' == _buf[_i+1], "Wrong Op")
             FFD_ENSURE_LFFD(is_line_whitespace (_buf[_i+2]), "Wrong Op")
-            Dbg << ">= ";
+            DbgD << ">= ";
             return _i+=2, ExprTokenType::opGE;
         case '=':
             FFD_ENSURE_LFFD('=' == _buf[_i+1], "Wrong Op")
             FFD_ENSURE_LFFD(is_line_whitespace (_buf[_i+2]), "Wrong Op")
-            Dbg << "== ";
+            DbgD << "== ";
             return _i+=2, ExprTokenType::opE;
         case '|':
             FFD_ENSURE_LFFD('|' == _buf[_i+1], "Wrong Op")
             FFD_ENSURE_LFFD(is_line_whitespace (_buf[_i+2]), "Wrong Op")
-            Dbg << "|| ";
+            DbgD << "|| ";
             return _i+=2, ExprTokenType::opOr;
         case '&':
             // require ' ' after &
             if (' ' == _buf[_i+1]) return _i+=1, ExprTokenType::opBWAnd;
             FFD_ENSURE_LFFD('&' == _buf[_i+1], "Wrong Op")
             FFD_ENSURE_LFFD(is_line_whitespace (_buf[_i+2]), "Wrong Op")
-            Dbg << "&& ";
+            DbgD << "&& ";
             return _i+=2, ExprTokenType::opAnd;
-        default: Dbg << "\"" << _buf[_i] << "\" <- ";
+        default: DbgD << "\"" << _buf[_i] << "\" <- ";
                  FFD_ENSURE_LFFD(1^1, "Unknown Op")
     }// switch (_buf[_i])
 }// FFDParser::TokenizeExpressionOp()
@@ -428,38 +428,38 @@ FFDParser::ExprTokenType FFDParser::TokenizeExpressionOp()
 // Handle (.*)
 List<FFDParser::ExprToken> FFDParser::TokenizeExpression()
 {
-    Dbg << "TokenizeExpression: ";
+    DbgD << "TokenizeExpression: ";
     List<FFDParser::ExprToken> result {}; // (, foo, )
     int depth {};
     int chk {};
     do {
-        if ('(' == _buf[_i]) { Dbg << "( ";
+        if ('(' == _buf[_i]) { DbgD << "( ";
             FFD_ENSURE_LFFD(chk++ < FFD_EXPR_MAX_NESTED_EXPR, "Wrong expr.")
             depth++; _i++;
             result.Put (FFDParser::ExprToken {ExprTokenType::Open});
         }
-        else if (')' == _buf[_i]) { Dbg << ") ";
+        else if (')' == _buf[_i]) { DbgD << ") ";
             depth--; if (depth) _i++;
             result.Put (FFDParser::ExprToken {ExprTokenType::Close});
         }
         else if (SymbolValid1st (_buf[_i])) {
             FFDParser::ExprToken t {ExprTokenType::Symbol};
-            t.Symbol = ReadSymbol (')', true); Dbg << "{" << t.Symbol << "} ";
+            t.Symbol = ReadSymbol (')', true); DbgD << "{" << t.Symbol << "} ";
             result.Put (static_cast<FFDParser::ExprToken &&>(t));
         }
         else if (is_decimal_number (_buf[_i])) {
             FFDParser::ExprToken t {ExprTokenType::Number};
-            t.Value = ParseIntLiteral (); Dbg << t.Value << " ";
+            t.Value = ParseIntLiteral (); DbgD << t.Value << " ";
             result.Put (static_cast<FFDParser::ExprToken &&>(t));
         }
-        else if (IsLineWhitespace ()) { Dbg << "{} "; SkipLineWhitespace (); }
+        else if (IsLineWhitespace ()) { DbgD << "{} "; SkipLineWhitespace (); }
         else
             result.Put (FFDParser::ExprToken {TokenizeExpressionOp ()});
     } while (depth && _i < _len);
     FFD_ENSURE_LFFD(')' == _buf[_i], "Incomplete expr.")
     FFD_ENSURE_LFFD(0 == depth, "Bug: incomplete expr.")
     _i++;
-    Dbg << EOL;
+    DbgD << EOL;
     return static_cast<List<ExprToken> &&>(result);
 }// FFDParser::TokenizeExpression()
 
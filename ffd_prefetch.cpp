@@ -0,0 +1,305 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_prefetch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FFD_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+FFD_NAMESPACE
+
+// The shared rings; no liburing: the 3 system calls and the ring protocol.
+struct FFDPrefetch::Ring final
+{
+#ifdef FFD_IO_URING
+    void * Sq {MAP_FAILED}, * Cq {MAP_FAILED};
+    size_t SqLen {}, CqLen {};
+    io_uring_sqe * Sqes {static_cast<io_uring_sqe *>(MAP_FAILED)};
+    size_t SqesLen {};
+    unsigned * SqTail {}, * SqMask {}, * SqArray {};
+    unsigned * CqHead {}, * CqTail {}, * CqMask {};
+    io_uring_cqe * Cqes {};
+    List<iovec> Iov {}; // by slot
+#endif
+};// FFDPrefetch::Ring
+
+FFDPrefetch::FFDPrefetch(int depth, bool uring)
+    : _depth {depth}
+{
+    FFD_ENSURE(depth > 0 && depth <= 1<<10, "FFDPrefetch: depth out of range")
+    for (int i = 0; i <= depth; i++) _slots.Add (Slot {});
+    pthread_mutex_init (&_lock, nullptr);
+    pthread_cond_init (&_queued, nullptr), pthread_cond_init (&_done, nullptr);
+    if (uring && RingInit ()) return;
+    int n = depth < 4 ? depth : 4;
+    for (int i = 0; i < n; i++) {
+        pthread_t t {};
+        FFD_ENSURE(0 == pthread_create (&t, nullptr, FFDPrefetch::Reader,
+            this), "FFDPrefetch: pthread_create failed")
+        _threads.Add (t);
+    }
+}
+
+FFDPrefetch::~FFDPrefetch()
+{
+    if (Uring ()) {
+        for (int i = 0; i < _slots.Count (); i++)
+            while (Slot::Reading == _slots[i].St) RingWait ();
+    }
+    else {
+        pthread_mutex_lock (&_lock);
+        _stop = true;
+        pthread_cond_broadcast (&_queued);
+        pthread_mutex_unlock (&_lock);
+        for (auto t : _threads) pthread_join (t, nullptr);
+    }
+    for (int i = 0; i < _slots.Count (); i++) Close (_slots[i]);
+#ifdef FFD_IO_URING
+    if (_r) {
+        if (MAP_FAILED != _r->Sqes) munmap (_r->Sqes, _r->SqesLen);
+        if (MAP_FAILED != _r->Cq && _r->Cq != _r->Sq)
+            munmap (_r->Cq, _r->CqLen);
+        if (MAP_FAILED != _r->Sq) munmap (_r->Sq, _r->SqLen);
+    }
+#endif
+    FFD_DESTROY_OBJECT(_r, Ring)
+    if (_ring >= 0) close (_ring);
+    FFD_DESTROY_OBJECT(_s, FFDMemoryStream)
+    pthread_cond_destroy (&_done), pthread_cond_destroy (&_queued);
+    pthread_mutex_destroy (&_lock);
+}
+
+/*static*/ bool FFDPrefetch::Open(Slot & s)
+{
+    s.Got = s.Size = 0;
+    s.Fd = open (s.Name, O_RDONLY | O_CLOEXEC);
+    if (s.Fd < 0) return false;
+    struct stat st {};
+    if (0 != fstat (s.Fd, &st) || ! S_ISREG(st.st_mode)
+        || st.st_size >= (1u<<31) - 1) return Close (s), false;
+    s.Size = static_cast<int>(st.st_size);
+    if (s.Buf.Length () < s.Size) s.Buf.Resize (s.Size);
+    return true;
+}
+
+/*static*/ void FFDPrefetch::Close(Slot & s)
+{
+    if (s.Fd >= 0) close (s.Fd), s.Fd = -1;
+}
+
+bool FFDPrefetch::Add(const char * file_name, int tag)
+{
+    if (_count >= _depth) return false;
+    int i = (_head + _count) % _slots.Count ();
+    auto & s = _slots[i];
+    s.Name = file_name, s.Tag = tag;
+    if (Uring ()) {
+        _count++;
+        if (! Open (s)) s.St = Slot::Failed;
+        else if (s.Size > 0) s.St = Slot::Reading, RingRead (i);
+        else s.St = Slot::Done, Close (s);
+        return true;
+    }
+    pthread_mutex_lock (&_lock);
+    _count++, s.St = Slot::Queued;
+    pthread_cond_signal (&_queued);
+    pthread_mutex_unlock (&_lock);
+    return true;
+}
+
+FFDMemoryStream * FFDPrefetch::Next()
+{
+    FFD_ENSURE(_count > 0, "FFDPrefetch: Next() without Add()")
+    FFD_DESTROY_OBJECT(_s, FFDMemoryStream)
+    _s = nullptr;
+    auto & s = _slots[_head];
+    if (Uring ()) {
+        while (Slot::Reading == s.St) RingWait ();
+        _head = (_head + 1) % _slots.Count (), _count--;
+    }
+    else {
+        pthread_mutex_lock (&_lock);
+        while (Slot::Done != s.St && Slot::Failed != s.St)
+            pthread_cond_wait (&_done, &_lock);
+        _head = (_head + 1) % _slots.Count (), _count--;
+        pthread_mutex_unlock (&_lock);
+    }
+    _tag = s.Tag;
+    bool ok = Slot::Done == s.St;
+    s.St = Slot::Free; // the buffer stays: the slot is re-used after Next()
+    if (! ok) return nullptr;
+    FFD_CREATE_OBJECT(_s, FFDMemoryStream) {s.Buf.operator byte * (),
+        static_cast<size_t>(s.Size)};
+    return _s;
+}
+
+// The oldest Queued one; whole, by pread().
+/*static*/ void * FFDPrefetch::Reader(void * p)
+{
+    auto & f = *static_cast<FFDPrefetch *>(p);
+    pthread_mutex_lock (&f._lock);
+    for (;;) {
+        Slot * s {};
+        for (int i = 0; ! s && i < f._count; i++) {
+            auto & q = f._slots[(f._head + i) % f._slots.Count ()];
+            if (Slot::Queued == q.St) s = &q;
+        }
+        if (! s) {
+            if (f._stop) break;
+            pthread_cond_wait (&f._queued, &f._lock);
+            continue;
+        }
+        s->St = Slot::Reading;
+        pthread_mutex_unlock (&f._lock);
+        bool ok = Open (*s);
+        while (ok && s->Got < s->Size) {
+            auto n = pread (s->Fd, s->Buf.operator byte * () + s->Got,
+                s->Size - s->Got, s->Got);
+            if (n < 0 && EINTR == errno) continue;
+            if (n < 0) ok = false;
+            else if (0 == n) s->Size = s->Got; // it got shorter
+            else s->Got += static_cast<int>(n);
+        }
+        Close (*s);
+        pthread_mutex_lock (&f._lock);
+        s->St = ok ? Slot::Done : Slot::Failed;
+        pthread_cond_broadcast (&f._done);
+    }
+    pthread_mutex_unlock (&f._lock);
+    return nullptr;
+}
+
+#ifdef FFD_IO_URING
+bool FFDPrefetch::RingInit()
+{
+    io_uring_params p {};
+    _ring = static_cast<int>(syscall (__NR_io_uring_setup, _depth, &p));
+    if (_ring < 0) return _ring = -1, false;
+    FFD_CREATE_OBJECT(_r, Ring) {};
+    auto & r = *_r;
+    r.SqLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r.CqLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && r.CqLen > r.SqLen) r.SqLen = r.CqLen;
+    r.Sq = mmap (nullptr, r.SqLen, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_SQ_RING);
+    r.Cq = single ? r.Sq : mmap (nullptr, r.CqLen, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_CQ_RING);
+    r.SqesLen = p.sq_entries * sizeof(io_uring_sqe);
+    r.Sqes = static_cast<io_uring_sqe *>(mmap (nullptr, r.SqesLen,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring,
+        IORING_OFF_SQES));
+    if (MAP_FAILED == r.Sq || MAP_FAILED == r.Cq || MAP_FAILED == r.Sqes) {
+        if (MAP_FAILED != r.Sqes) munmap (r.Sqes, r.SqesLen);
+        if (MAP_FAILED != r.Cq && r.Cq != r.Sq) munmap (r.Cq, r.CqLen);
+        if (MAP_FAILED != r.Sq) munmap (r.Sq, r.SqLen);
+        FFD_DESTROY_OBJECT(_r, Ring)
+        _r = nullptr;
+        close (_ring);
+        return _ring = -1, false;
+    }
+    auto sq = static_cast<byte *>(r.Sq), cq = static_cast<byte *>(r.Cq);
+    r.SqTail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+    r.SqMask = reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+    r.SqArray = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+    r.CqHead = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+    r.CqTail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+    r.CqMask = reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+    r.Cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+    for (int i = 0; i < _slots.Count (); i++) r.Iov.Add (iovec {});
+    return true;
+}
+
+// One READV of what is left of it; user_data: the slot.
+void FFDPrefetch::RingRead(int slot)
+{
+    auto & s = _slots[slot];
+    auto & v = _r->Iov[slot];
+    v.iov_base = s.Buf.operator byte * () + s.Got;
+    v.iov_len = static_cast<size_t>(s.Size - s.Got);
+    unsigned tail = *(_r->SqTail), i = tail & *(_r->SqMask);
+    auto & e = _r->Sqes[i];
+    memset (&e, 0, sizeof(e));
+    e.opcode = IORING_OP_READV, e.fd = s.Fd;
+    e.addr = reinterpret_cast<unsigned long>(&v), e.len = 1;
+    e.off = static_cast<unsigned long>(s.Got), e.user_data = slot;
+    _r->SqArray[i] = i;
+    __atomic_store_n (_r->SqTail, tail + 1, __ATOMIC_RELEASE);
+    long n {};
+    while ((n = syscall (__NR_io_uring_enter, _ring, 1, 0, 0, nullptr, 0)) < 0
+        && EINTR == errno)
+        ;
+    FFD_ENSURE(1 == n, "FFDPrefetch: io_uring_enter failed")
+}
+
+// At least one completion; short reads are re-submitted.
+void FFDPrefetch::RingWait()
+{
+    if (syscall (__NR_io_uring_enter, _ring, 0, 1, IORING_ENTER_GETEVENTS,
+        nullptr, 0) < 0)
+        FFD_ENSURE(EINTR == errno, "FFDPrefetch: io_uring_enter failed")
+    unsigned head = *(_r->CqHead),
+        tail = __atomic_load_n (_r->CqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        auto & c = _r->Cqes[head & *(_r->CqMask)];
+        int slot = static_cast<int>(c.user_data), res = c.res;
+        __atomic_store_n (_r->CqHead, head + 1, __ATOMIC_RELEASE);
+        auto & s = _slots[slot];
+        if (-EINTR == res || -EAGAIN == res) { RingRead (slot); continue; }
+        if (res < 0) { s.St = Slot::Failed, Close (s); continue; }
+        if (0 == res) s.Size = s.Got; // it got shorter
+        else s.Got += res;
+        if (s.Got < s.Size) RingRead (slot);
+        else s.St = Slot::Done, Close (s);
+    }
+}
+#else
+bool FFDPrefetch::RingInit() { return false; }
+void FFDPrefetch::RingRead(int) {}
+void FFDPrefetch::RingWait() {}
+#endif
+
+NAMESPACE_FFD
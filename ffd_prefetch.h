@@ -0,0 +1,113 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// Files read ahead: a few in flight while the one before them is parsed.
+
+#ifndef _FFD_PREFETCH_H_
+#define _FFD_PREFETCH_H_
+
+#include "ffd_model.h"
+#include "ffd_memory_stream.h"
+
+#include <pthread.h>
+
+FFD_NAMESPACE
+
+// Usage:
+//   FFDPrefetch p {8};
+//   while (...) {
+//       while (p.Count () < p.Depth () && more) p.Add (next_name);
+//       auto s = p.Next ();
+//       if (s) ffd.File2Tree (*s, ctx);
+//   }
+// Each file is read whole, to a buffer of its own; Next() hands them back in
+// Add() order. io_uring when the kernel allows it - Add() opens the file, the
+// ring reads it; a pool of reader threads otherwise. One thread calls Add()
+// and Next().
+class FFD_EXPORT FFDPrefetch final
+{
+    // "depth": files in flight, at most; "uring": false - the threads.
+    public: FFDPrefetch(int depth, bool uring = true);
+    public: ~FFDPrefetch();
+    public: FFDPrefetch(const FFDPrefetch &) = delete;
+    public: FFDPrefetch & operator=(const FFDPrefetch &) = delete;
+
+    // Starts reading "file_name" - it must outlive Next() of it; false:
+    // Depth() are in flight already. "tag": Tag() when Next() gives it.
+    public: bool Add(const char * file_name, int tag = 0);
+    // Added and not yet handed back by Next().
+    public: inline int Count() const { return _count; }
+    public: inline int Depth() const { return _depth; }
+    // The oldest one added: waits for it. Null: it could not be read. Valid
+    // until the next Next().
+    public: FFDMemoryStream * Next();
+    public: inline int Tag() const { return _tag; } // of the last Next()
+    // io_uring: false - the reader threads.
+    public: inline bool Uring() const { return _ring >= 0; }
+
+    private: struct Slot final
+    {
+        const char * Name {};
+        int Tag {};
+        int Fd {-1};
+        ByteArray Buf {};
+        int Size {}, Got {};
+        enum State { Free, Queued, Reading, Done, Failed } St {Free};
+    };
+    private: int _depth;
+    private: List<Slot> _slots {}; // a ring: _depth + the one Next() gave
+    private: int _head {}, _count {}; // the oldest one; in flight + done
+    private: FFDMemoryStream * _s {};
+    private: int _tag {};
+    // Fd, Size and Buf of Name; false: it can not be read.
+    private: static bool Open(Slot &);
+    private: static void Close(Slot &);
+    // io_uring: the fd, the rings
+    private: int _ring {-1};
+    private: struct Ring;
+    private: Ring * _r {};
+    private: bool RingInit();
+    private: void RingRead(int slot);
+    private: void RingWait();
+    // the reader threads
+    private: List<pthread_t> _threads {};
+    private: pthread_mutex_t _lock;
+    private: pthread_cond_t _queued, _done;
+    private: bool _stop {};
+    private: static void * Reader(void *);
+};// FFDPrefetch
+
+NAMESPACE_FFD
+
+#endif
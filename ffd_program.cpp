@@ -0,0 +1,205 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_program.h"
+
+FFD_NAMESPACE
+
+// How deep "Foo;" gets inlined; deeper ones are left to the tree-walk.
+#define FFD_MAX_INLINE_DEPTH 8
+
+// Named array dimension, known prior the data: one unconditional int const.
+static FFD::SNode * static_dim(FFD::SNode * base, const String & name)
+{
+    auto list = base->NodesByName (name);
+    if (1 != list.Count ()) return nullptr;
+    auto m = list[0];
+    return m->IsIntConst () && ! m->HasExpr () ? m : nullptr;
+}
+
+// SNode::PrecomputeSize() that can't change from one file to another.
+static bool static_layout(FFD::SNode * sn)
+{
+    if (sn->Fields.Empty ()) return false;
+    for (auto f : sn->Fields) {
+        if (f->HasExpr () || f->Variadic || f->HashKey) return false;
+        if (! f->DType || f->DType->HasExpr ()) return false;
+        if (! f->DType->IsMachType () && ! f->DType->IsEnum ()) return false;
+        if (! f->Array) continue;
+        for (int i = 0; i < FFD_MAX_ARR_DIMS && ! f->Arr[i].None (); i++)
+            if (f->Arr[i].Name.Empty () ? f->Arr[i].Value <= 0
+                : ! static_dim (sn, f->Arr[i].Name)) return false;
+    }
+    return true;
+}
+
+FFDProgram::FFDProgram(FFD::SNode * head)
+{
+    FFD_ENSURE(nullptr != head, "FFDProgram: nothing to compile")
+    head->WalkForward ([&](FFD::SNode * sn) {
+        while (_entry.Count () <= sn->Ordinal) _entry.Add (-1);
+        // The parametrized ones are resolved per instance.
+        if (sn->IsStruct () && ! sn->Parametrized ()) {
+            _entry[sn->Ordinal] = _ops.Count ();
+            Lower (sn, 0);
+            Emit (Op {});
+        }
+        return true;
+    });
+    // The fixed-layout Struct-s: a known size, and nothing but data to read.
+    for (int pc = 0; pc < _ops.Count (); pc++) {
+        auto & op = _ops[pc];
+        if (OpCode::Struct != op.Code || op.Field->Array) continue;
+        auto t = op.Type;
+        if (t->Parametrized () || op.Field->Parametrized ()
+            || ! static_layout (t)) continue;
+        auto entry = EntryOf (t);
+        if (entry < 0) continue;
+        bool plain {true};
+        for (int i = entry; plain && OpCode::End != _ops[i].Code; i++)
+            plain = OpCode::Span == _ops[i].Code
+                || OpCode::Scalar == _ops[i].Code
+                || OpCode::Block == _ops[i].Code;
+        if (plain) op.A = t->PrecomputeSize ();
+    }
+    DbgD << "FFDProgram: " << _ops.Count () << " ops" << EOL;
+}
+
+// EvalArray() when the array size and the item size are known.
+bool FFDProgram::LowerBlock(Op & result, FFD::SNode * n)
+{
+    Op op {result};
+    auto t = n->DType;
+    if (nullptr == t || n->HashKey) return false;
+    long long items {1}, limit {1<<23};
+    if ((t->IsMachType () || t->IsEnum ()) && ! t->HasExpr ())
+        op.B = t->Size;
+    else if (t->IsStruct () && ! t->Parametrized () && ! n->Parametrized ()
+        && static_layout (t))
+        op.B = t->PrecomputeSize (), limit = 1<<21;
+    else return false;
+    if (op.B <= 0) return false;
+    for (int i = 0; i < FFD_MAX_ARR_DIMS && ! n->Arr[i].None (); i++) {
+        auto & d = n->Arr[i];
+        int v {};
+        if (! d.Name.Empty ()) {
+            auto m = static_dim (n->Base, d.Name);
+            if (! m) return false;
+            v = m->IntLiteral;
+        }
+        else v = d.Value;
+        // 0 and the suspicious ones: let EvalArray() report them
+        if (v <= 0 || (items *= v) > 1<<23) return false;
+        op.Dim[i] = v;
+    }
+    if (items * op.B > limit) return false;
+    op.A = static_cast<int>(items * op.B);
+    op.Code = OpCode::Block;
+    return result = op, true;
+}// FFDProgram::LowerBlock()
+
+int FFDProgram::EmitData(const Op & op, int bytes)
+{
+    auto span = _span;
+    if (span >= 0 && _ops[span].A > (1<<23) - bytes) span = -1; // too big
+    if (span < 0) {
+        Op o {};
+        o.Code = OpCode::Span;
+        span = Emit (o);
+    }
+    auto pc = Emit (op);
+    _span = span, _ops[span].A += bytes, _ops[span].B++;
+    return pc;
+}
+
+void FFDProgram::Lower(FFD::SNode * sn, int depth)
+{
+    List<int> exits {}; // Struct, Field: "no more fields" - past this list
+    for (auto n : sn->Fields) {
+        Op op {};
+        auto t = n->DType;
+        op.Code = OpCode::Field, op.Struct = sn, op.Field = n, op.Type = t;
+        bool inline_it {};
+        if (t && t->IsStruct ()) {
+            if (n->Composite && ! n->Parametrized ()) {
+                if (depth < FFD_MAX_INLINE_DEPTH && ! t->Parametrized ())
+                    inline_it = true, op.Code = OpCode::Use;
+            }
+            else if (! (n->Array && LowerBlock (op, n)))
+                op.Code = OpCode::Struct;
+        }
+        else if (n->Variadic) {
+            List<String> names =
+                static_cast<List<String> &&> (n->Name.Split ('.'));
+            if (names.Count () > 0 && ! (FFD_STRUCT_BY_NAME == names[0])) {
+                List<FFD::SNode *> candidates {};
+                for (auto c : sn->NodesByName (n->Name))
+                    if (c->VListItem) candidates.Add (c);
+                op.A = _names.Count ();
+                _names.Put (static_cast<List<String> &&>(names));
+                _candidates.Put (static_cast<List<FFD::SNode *> &&>(
+                    candidates));
+                op.Code = OpCode::Variadic;
+            }
+        }
+        else if (n->Array) LowerBlock (op, n);
+        else if (t && (t->IsMachType () || t->IsEnum ()) && ! t->HasExpr ()
+            && t->Size >= 0 && t->Size <= FFD_MAX_MACHTYPE_SIZE
+            && ! n->HashKey && ! n->StopsParsing ())
+            op.Code = OpCode::Scalar;
+
+        // "Field" evaluates its own expression.
+        int branch {-1};
+        if (OpCode::Field != op.Code && n->HasExpr ()) {
+            Op b {};
+            b.Code = OpCode::Branch, b.Struct = sn, b.Field = n;
+            branch = Emit (b);
+        }
+        int pc {};
+        if (branch < 0 && OpCode::Scalar == op.Code)
+            pc = EmitData (op, t->Size);
+        else if (branch < 0 && OpCode::Block == op.Code)
+            pc = EmitData (op, op.A);
+        else pc = Emit (op);
+        if (OpCode::Struct == op.Code || OpCode::Field == op.Code)
+            exits.Add (pc);
+        if (inline_it) Lower (t, depth + 1);
+        if (branch >= 0) _ops[branch].A = _ops.Count () - branch - 1;
+    }
+    for (auto pc : exits) _ops[pc].B = _ops.Count ();
+}// FFDProgram::Lower()
+
+#undef FFD_MAX_INLINE_DEPTH
+
+NAMESPACE_FFD
@@ -0,0 +1,115 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// while(theres_data).read(how_many).put_it(where) - decided once, not per file
+
+#ifndef _FFD_PROGRAM_H_
+#define _FFD_PROGRAM_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+FFD_NAMESPACE
+
+// The description, lowered to a linear list of decode ops: one list per
+// struct, ending with "End". FFDNode runs it instead of re-discovering, per
+// field and per file, what kind of field it is looking at.
+// What can't be decided prior the data - parametrized structs, types
+// resolved at runtime, "... struct" dispatch, hash keys, dimensions that
+// are fields - is lowered to "Field": the tree-walk handles it, one field at
+// a time. Consecutive unconditional "Scalar" and "Block" ops - a fixed-layout
+// struct, or a part of one - are preceded by "Span": one read for all of
+// them. Read-only once built.
+class FFD_EXPORT FFDProgram final
+{
+    public: enum class OpCode {End, Branch, Use, Scalar, Block, Struct,
+        Variadic, Field, Span};
+    public: struct Op final
+    {
+        OpCode Code {OpCode::End};
+        FFD::SNode * Struct {}; // the one "Field" belongs to
+        FFD::SNode * Field {};
+        FFD::SNode * Type {};   // Field->DType
+        // Branch: ops to skip; Block, Span: bytes; Variadic: key id;
+        // Struct: bytes when the struct is fixed-layout - it can be skipped
+        int A {};
+        int B {}; // Block: item size; Struct, Field: where to go on "skip";
+                  // Span: the Scalar and Block ops it reads for
+        int Dim[FFD_MAX_ARR_DIMS] {}; // Block: FFDNode::_arr_dim
+    };
+
+    // "head" - the 1st node of the description.
+    public: FFDProgram(FFD::SNode * head);
+    public: ~FFDProgram() {}
+
+    // Returns -1 when "sn" hasn't been compiled.
+    public: inline int EntryOf(FFD::SNode * sn) const
+    {
+        if (nullptr == sn || nullptr != sn->Base) return -1;
+        if (sn->Ordinal < 0 || sn->Ordinal >= _entry.Count ()) return -1;
+        return _entry[sn->Ordinal];
+    }
+    public: inline const Op & operator[](int pc) const { return _ops[pc]; }
+    public: inline int Count() const { return _ops.Count (); }
+    // Variadic: the key "a.b.c", and the "struct a.b.c:n" that could match.
+    public: inline const List<String> & Names(int i) const
+    {
+        return _names[i];
+    }
+    public: inline const List<FFD::SNode *> & Candidates(int i) const
+    {
+        return _candidates[i];
+    }
+
+    private: List<Op> _ops {};
+    private: List<int> _entry {}; // by SNode::Ordinal; -1 - not compiled
+    private: List<List<String>> _names {};
+    private: List<List<FFD::SNode *>> _candidates {};
+    private: int _span {-1}; // the open Span op; -1: none
+
+    private: inline int Emit(const Op & op)
+    {
+        if (OpCode::Use != op.Code) _span = -1;
+        return _ops.Add (op), _ops.Count () - 1;
+    }
+    // Emit() for Scalar and Block: opens a Span or extends the open one.
+    private: int EmitData(const Op & op, int bytes);
+    // Appends the fields of "sn"; "depth" - of inlined composite structs.
+    private: void Lower(FFD::SNode * sn, int depth);
+    private: bool LowerBlock(Op &, FFD::SNode * n);
+};// FFDProgram
+
+NAMESPACE_FFD
+
+#endif
@@ -0,0 +1,115 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_projection.h"
+
+#include <string.h>
+
+FFD_NAMESPACE
+
+FFDProjection::FFDProjection(const FFD & ffd, const List<String> & paths)
+{
+    _steps.Add (Step {});
+    for (auto & p : paths) Add (p);
+
+    // What the data depend on - by name; see FFDNode::ResolveSymbols().
+    List<String> names {}, tables {};
+    auto name = [&](const String & path) {
+        String copy {path};
+        for (auto & n : copy.Split ('.')) names.Add (n);
+    };
+    auto expr = [&](const List<FFDParser::ExprToken> & e) {
+        for (auto & t : e)
+            if (FFDParser::ExprTokenType::Symbol == t.Type) name (t.Symbol);
+    };
+    int count {};
+    auto deps = [&](FFD::SNode * n) {
+        if (n->Id >= count) count = n->Id + 1;
+        expr (n->Expr);
+        for (auto & i : n->EnumItems) expr (i.Expr);
+        for (int i = 0; i < FFD_MAX_ARR_DIMS; i++)
+            if (! n->Arr[i].Name.Empty ()) name (n->Arr[i].Name);
+        if (n->Variadic) name (n->Name);
+        for (auto & p : n->PS) names.Add (p.Name), names.Add (p.Bind);
+        if (n->HashKey) tables.Add (n->HashType);
+        if (n->StopsParsing ()) names.Add (n->Name);
+    };
+    ffd.Head ()->WalkForward ([&](FFD::SNode * n) {
+        deps (n);
+        for (auto f : n->Fields) deps (f);
+        return true;
+    });
+
+    auto in = [](const List<String> & list, const String & s) {
+        for (auto & i : list) if (i == s) return true;
+        return false;
+    };
+    for (int i = 0; i < count; i++) _keep.Add (0);
+    ffd.Head ()->WalkForward ([&](FFD::SNode * n) {
+        if (in (tables, n->Name)) _keep[n->Id] = 1;
+        for (auto f : n->Fields) if (in (names, f->Name)) _keep[f->Id] = 1;
+        return true;
+    });
+    DbgD << "FFDProjection: " << _steps.Count () - 1 << " steps, "
+        << names.Count () << " names kept" << EOL;
+}// FFDProjection::FFDProjection()
+
+void FFDProjection::Add(const String & path)
+{
+    String copy {path};
+    int at {ROOT};
+    for (auto & s : copy.Split ('.')) {
+        String name {s};
+        auto len = name.Length ();
+        if (len > 3 && ! strcmp (name.AsZStr () + len - 3, "[*]"))
+            name = String {reinterpret_cast<const byte *>(name.AsZStr ()),
+                len - 3};
+        FFD_ENSURE(! name.Empty (), "FFDProjection: empty path step")
+        FFD_ENSURE(nullptr == strchr (name.AsZStr (), '['),
+            "FFDProjection: only \"[*]\" is supported")
+        int next {-1};
+        for (int i = at + 1; i < _steps.Count () && next < 0; i++)
+            if (_steps[i].Parent == at && _steps[i].Name == name) next = i;
+        if (next < 0) {
+            Step step {};
+            step.Name = name, step.Parent = at;
+            _steps.Add (step), next = _steps.Count () - 1;
+        }
+        at = next;
+    }
+    FFD_ENSURE(ROOT != at, "FFDProjection: empty path")
+    _steps[at].Whole = true;
+}
+
+NAMESPACE_FFD
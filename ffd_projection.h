@@ -0,0 +1,99 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// Some paths of the tree, and what they depend on: File2Tree() builds just
+// those; see FFD::ParseContext::Projection.
+
+#ifndef _FFD_PROJECTION_H_
+#define _FFD_PROJECTION_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+FFD_NAMESPACE
+
+// Usage:
+//   List<String> paths {};
+//   paths.Add ("H.Version"), paths.Add ("Players[*].Name");
+//   FFDProjection p {ffd, paths};
+//   FFD::ParseContext ctx {ffd};
+//   ctx.Projection = &p;
+//   auto tree = ffd.File2Tree (s, ctx);
+// A path is FieldNode ()->Name-s, from the root, separated by "."; "[*]" -
+// all items of an array - is optional: "Players.Name" is the same path. What
+// a path ends at is built whole.
+// Besides the paths, the fields the data depends on are built whole: those
+// named by an expression, an array dimension, a "..." key or a parametrized
+// struct, and the hash tables. By name - whichever struct they're at. The
+// rest is skipped when its size is known - no FFDNode for it - and built
+// then dropped otherwise; a struct is kept while it has a field that is.
+// Read-only once built: one can be shared by many ParseContext-s.
+class FFD_EXPORT FFDProjection final
+{
+    // The state of a node: a path step, or one of these.
+    public: static int constexpr ALL {-1};  // build it whole
+    public: static int constexpr NONE {-2}; // not on a path
+    public: static int constexpr ROOT {0};  // the root node
+
+    public: FFDProjection(const FFD &, const List<String> & paths);
+    public: ~FFDProjection() {}
+
+    // The state of field "f" of a node at state "at"; "dt": the DType of
+    // "f" at this input.
+    public: inline int Child(int at, const FFD::SNode * f,
+        const FFD::SNode * dt) const
+    {
+        if (ALL == at || _keep[f->Id] || (dt && _keep[dt->Id])) return ALL;
+        if (at < 0) return NONE;
+        for (int i = at + 1; i < _steps.Count (); i++)
+            if (_steps[i].Parent == at && _steps[i].Name == f->Name)
+                return _steps[i].Whole ? ALL : i;
+        return NONE;
+    }
+
+    private: struct Step final
+    {
+        String Name {};
+        int Parent {-1};
+        bool Whole {};
+    };
+    private: List<Step> _steps {}; // a trie; [ROOT] - the root node
+    // by SNode::Id: fields the data depend on, and hash table types
+    private: List<byte> _keep {};
+    private: void Add(const String & path);
+};// FFDProjection
+
+NAMESPACE_FFD
+
+#endif
@@ -0,0 +1,86 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_struct_array.h"
+#include "ffd_node.h"
+
+FFD_NAMESPACE
+
+FFDStructArray::FFDStructArray(FFDNode * array)
+{
+    FFD_ENSURE(array && array->_array && array->_array_item_size > 0,
+        "FFDStructArray: not an array of fixed-size items")
+    FFD_ENSURE(! array->IsHuge (), "FFDStructArray: a huge one - see "
+        "FFDArrayCursor")
+    auto dt = array->_dt;
+    FFD_ENSURE(dt && dt->IsStruct (), "FFDStructArray: not of structs")
+    _count = array->NodeCount (), _stride = array->_array_item_size;
+    _p = array->_data.operator byte * ();
+    Layout (dt);
+}
+
+FFDStructArray::FFDStructArray(const FFDTable::Node & array)
+{
+    FFD_ENSURE(array && array.R ().Array && array.R ().ItemSize > 0,
+        "FFDStructArray: not an array of fixed-size items")
+    auto dt = array.R ().DType;
+    FFD_ENSURE(dt && dt->IsStruct (), "FFDStructArray: not of structs")
+    _count = array.NodeCount (), _stride = array.R ().ItemSize;
+    _p = array.Data ();
+    Layout (dt);
+}
+
+void FFDStructArray::Layout(FFD::SNode * dt)
+{
+    // see FFD::SNode::PrecomputeSize(); no ParseContext: the one of the
+    // tree could be gone
+    int at {};
+    for (auto f : dt->Fields) {
+        Field fd {f, f->DType, at, f->FixedCount ()};
+        FFD_ENSURE(fd.DType && fd.Count > 0, "FFDStructArray: the layout "
+            "depends on the input")
+        _fields.Add (fd), at += fd.Count * fd.DType->Size;
+    }
+    FFD_ENSURE(at == _stride, "FFDStructArray: the layout depends on the "
+        "input")
+}
+
+int FFDStructArray::IndexOf(const String & name) const
+{
+    for (int i = 0; i < _fields.Count (); i++)
+        if (_fields[i].Node->Name == name) return i;
+    return -1;
+}
+
+NAMESPACE_FFD
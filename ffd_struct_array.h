@@ -0,0 +1,118 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// The items of an array of fixed-size structs - see FFD::SNode::
+// PrecomputeSize() - read in place: no FFDNode per item.
+
+#ifndef _FFD_STRUCT_ARRAY_H_
+#define _FFD_STRUCT_ARRAY_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+#include "ffd_table.h"
+
+FFD_NAMESPACE
+
+class FFDNode;
+
+// Usage:
+//   FFDStructArray tiles {tree->NodeByName ("Tiles")};
+//   int terrain = tiles.IndexOf ("Terrain");
+//   for (int i = 0; i < tiles.Count (); i++)
+//       use (tiles.AsInt (i, terrain));
+// The layout is the one of the description: a field is at the same offset
+// at all items. The data are in the host byte order; see FFD::SNode::Swap.
+// Valid while the array node is. Not range-checked: Count(), Fields().
+class FFD_EXPORT FFDStructArray final
+{
+    // "array": of fixed-size structs - not ArrayOfFields(), not IsHuge() -
+    // see FFDArrayCursor for those.
+    public: FFDStructArray(FFDNode * array);
+    // The same, of an FFDTable; valid while the table is.
+    public: FFDStructArray(const FFDTable::Node & array);
+    public: ~FFDStructArray() {}
+
+    public: struct Field final
+    {
+        FFD::SNode * Node;  // the field
+        FFD::SNode * DType; // a machine type or an enum
+        int Offset;         // at the item [bytes]
+        int Count;          // items: 1 - unless it is an array
+    };
+    public: inline int Count() const { return _count; } // items
+    public: inline int Stride() const { return _stride; } // [bytes]
+    public: inline int Fields() const { return _fields.Count (); }
+    public: inline const Field & FieldAt(int f) const { return _fields[f]; }
+    // The index of field "name"; -1: there is none.
+    public: int IndexOf(const String & name) const;
+
+    public: inline const byte * Item(int i) const
+    {
+        return _p + static_cast<long>(i) * _stride;
+    }
+    // Item "j" of field "f" of item "i".
+    public: inline const byte * At(int i, int f, int j = 0) const
+    {
+        auto & fd = _fields[f];
+        return Item (i) + fd.Offset + j * fd.DType->Size;
+    }
+    public: template <typename T> inline T As(int i, int f, int j = 0) const
+    {
+        T result;
+        return OS::Memcpy (&result, At (i, f, j), sizeof (T)), result;
+    }
+    // Of an int type field: see FFD::SNode::IsIntType().
+    public: inline int AsInt(int i, int f, int j = 0) const
+    {
+        auto dt = _fields[f].DType;
+        switch (dt->Size) {
+            case 1: return dt->Signed ? As<signed char> (i, f, j)
+                : As<byte> (i, f, j);
+            case 2: return dt->Signed ? As<short> (i, f, j)
+                : As<unsigned short> (i, f, j);
+            case 4: return As<int> (i, f, j);
+            default: FFD_ENSURE(0, "FFDStructArray: not an int field")
+        }
+    }
+
+    private: const byte * _p {};
+    private: int _count {}, _stride {};
+    private: List<Field> _fields {};
+    // The _fields of item type "dt", and a check of _stride against them.
+    private: void Layout(FFD::SNode * dt);
+};// FFDStructArray
+
+NAMESPACE_FFD
+
+#endif
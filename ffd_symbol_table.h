@@ -0,0 +1,131 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// name -> node(s); so lookups stop walking the whole description
+
+#ifndef _FFD_SYMBOL_TABLE_H_
+#define _FFD_SYMBOL_TABLE_H_
+
+#include "ffd_model.h"
+
+FFD_NAMESPACE
+
+// Hash index of named nodes. T is anything that has a "String Name".
+// Nodes sharing a name are kept in the order they were added; a.k.a. in
+// description order, because that's what the lookup rules are based on.
+// Nothing gets removed - the description doesn't change once parsed.
+template <typename T> class SymbolTable final
+{
+    public: SymbolTable() {}
+    public: ~SymbolTable() {}
+
+    // Returns IndexOf (node->Name).
+    public: inline int Add(T * node)
+    {
+        FFD_ENSURE(nullptr != node, "SymbolTable: node can't be null")
+        if (_entries.Count () >= (_heads.Count () >> 1)) Rehash ();
+        auto h = Hash (node->Name);
+        auto e = Lookup (node->Name, h);
+        if (e < 0) {
+            Entry entry {};
+            entry.Hash = h;
+            entry.Next = _heads[h & (_heads.Count () - 1)];
+            e = _heads[h & (_heads.Count () - 1)] = _entries.Count ();
+            _entries.Put (static_cast<Entry &&>(entry));
+        }
+        _entries[e].Nodes.Add (node);
+        return e;
+    }
+
+    // Returns null when there is no such name.
+    public: inline const List<T *> * Find(const String & name) const
+    {
+        if (_heads.Empty ()) return nullptr;
+        auto e = Lookup (name, Hash (name));
+        return e < 0 ? nullptr : &(_entries[e].Nodes);
+    }
+
+    // Of the name: 0 ... Count()-1, in the order they were 1st added; -1:
+    // there is no such name.
+    public: inline int IndexOf(const String & name) const
+    {
+        return _heads.Empty () ? -1 : Lookup (name, Hash (name));
+    }
+
+    public: inline int Count() const { return _entries.Count (); }
+
+    // FNV-1a; modulo 2^32 in 64 bits: it doesn't wrap - no reports from
+    // -fsanitize=integer
+    public: static inline unsigned int Hash(const String & s)
+    {
+        unsigned long long h {2166136261u};
+        auto p = reinterpret_cast<const byte *>(s.AsZStr ());
+        for (int i = 0; i < s.Length (); i++)
+            h = ((h ^ p[i]) * 16777619u) & 0xffffffffu;
+        return static_cast<unsigned int>(h);
+    }
+
+    private: struct Entry final
+    {
+        unsigned int Hash {};
+        int Next {-1}; // chain; index at _entries
+        List<T *> Nodes {};
+    };
+    private: List<Entry> _entries {};
+    private: List<int> _heads {}; // power of 2; index at _entries or -1
+
+    private: inline int Lookup(const String & name, unsigned int h) const
+    {
+        for (int e = _heads[h & (_heads.Count () - 1)]; e >= 0;
+            e = _entries[e].Next)
+            if (h == _entries[e].Hash && name == _entries[e].Nodes[0]->Name)
+                return e;
+        return -1;
+    }
+    private: inline void Rehash()
+    {
+        int size = _heads.Count () > 0 ? _heads.Count () << 1 : 64;
+        _heads = List<int> {};
+        for (int i = 0; i < size; i++) _heads.Add (-1);
+        for (int e = 0; e < _entries.Count (); e++) {
+            auto & b = _heads[_entries[e].Hash & (size - 1)];
+            _entries[e].Next = b;
+            b = e;
+        }
+    }
+};// SymbolTable
+
+NAMESPACE_FFD
+
+#endif
@@ -0,0 +1,111 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+#include "ffd_table.h"
+#include "ffd_node.h"
+
+FFD_NAMESPACE
+
+// Where "ofs" goes for a span of "len" bytes: the natural alignment of the
+// machine types that could be read from it - As<int>(), AsArr<short>(), ...
+static inline int table_align(int ofs, int len)
+{
+    int a = len >= 8 ? 8 : len >= 4 ? 4 : len >= 2 ? 2 : 1;
+    return (ofs + a - 1) & ~(a - 1);
+}
+
+namespace {
+struct HtIndex final
+{
+    const FFDNode * Node;
+    int Index;
+    static int Cmp(const void * a, const void * b)
+    {
+        auto x = static_cast<const HtIndex *>(a)->Node;
+        auto y = static_cast<const HtIndex *>(b)->Node;
+        return x < y ? -1 : x > y ? 1 : 0;
+    }
+};
+}
+
+FFDTable::FFDTable(FFDNode * tree)
+{
+    if (nullptr == tree) return;
+    // Breadth-first: the children of a record are added at once, so they're
+    // consecutive; src[i] is the FFDNode of _records[i].
+    List<FFDNode *> src {};
+    src.Add (tree);
+    _records.Add (Record {tree->FieldNode (), tree->_dt});
+    int bytes {}, hk {};
+    for (int i = 0; i < src.Count (); i++) {
+        auto n = src[i];
+        n->Need (); // FFD::ParseContext::Lazy
+        _records[i].First = src.Count ();
+        _records[i].Count = n->_fields.Count ();
+        for (auto f : n->_fields) {
+            src.Add (f);
+            _records.Add (Record {f->FieldNode (), f->_dt, i});
+        }
+        auto & r = _records[i];
+        r.Length = n->_data.Length ();
+        r.Data = bytes = table_align (bytes, r.Length);
+        bytes += r.Length;
+        r.ItemSize = n->_array_item_size;
+        r.Signed = n->_signed;
+        r.Array = n->_array;
+        r.HashKey = n->_hk;
+        if (n->_hk) hk++;
+    }
+    _bytes.Resize (bytes);
+    for (int i = 0; i < src.Count (); i++)
+        if (_records[i].Length > 0)
+            OS::Memmove (_bytes.operator byte * () + _records[i].Data,
+                src[i]->_data.operator byte * (), _records[i].Length);
+
+    if (! hk) return;
+    // FFDNode::_ht -> the index of its record
+    List<HtIndex> map {};
+    for (int i = 0; i < src.Count (); i++) map.Add (HtIndex {src[i], i});
+    qsort (&map[0], map.Count (), sizeof(HtIndex), HtIndex::Cmp);
+    for (int i = 0; i < src.Count (); i++) {
+        if (! _records[i].HashKey || nullptr == src[i]->_ht) continue;
+        HtIndex key {src[i]->_ht, -1};
+        auto found = static_cast<HtIndex *>(bsearch (&key, &map[0],
+            map.Count (), sizeof(HtIndex), HtIndex::Cmp));
+        FFD_ENSURE(nullptr != found, "HashTable outside of the tree")
+        _records[i].Ht = found->Index;
+    }
+}
+
+NAMESPACE_FFD
@@ -0,0 +1,268 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// A File2Tree() tree, flattened: fixed-size records in one array, the data of
+// all of them in one buffer. The children of a record are consecutive
+// records; a record refers to them by index, not by pointer.
+// FFDTable::Node is the handle: the part of the FFDNode API that reads a tree.
+
+#ifndef _FFD_TABLE_H_
+#define _FFD_TABLE_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+FFD_NAMESPACE
+
+class FFDNode;
+
+class FFD_EXPORT FFDTable final
+{
+    public: struct Record final
+    {
+        FFD::SNode * Field {};  // FFDNode::FieldNode()
+        FFD::SNode * DType {};  // the one at the input; see FFD::ParseContext
+        int Parent {-1};        // -1: the root
+        int First {}, Count {}; // the children: [First, First + Count)
+        int Data {}, Length {}; // [bytes] at Bytes()
+        int ItemSize {};        // [bytes]; 0: an array of fields, if Array
+        int Ht {-1};            // the hash table of a hash key; -1: none
+        bool Signed {}, Array {}, HashKey {};
+    };
+
+    // Copies "tree"; free it (or reset its FFDArena) afterwards.
+    public: FFDTable(FFDNode * tree);
+    public: ~FFDTable() {}
+
+    class Node;
+    public: class Range final
+    {
+        public: class Iterator final
+        {
+            public: Iterator(const FFDTable * t, int i) : _t {t}, _i {i} {}
+            public: inline Node operator*() const { return Node {_t, _i}; }
+            public: inline Iterator & operator++() { return ++_i, *this; }
+            public: inline bool operator!=(const Iterator & v) const
+            {
+                return _i != v._i;
+            }
+            private: const FFDTable * _t;
+            private: int _i;
+        };
+        public: Range(const FFDTable * t, int first, int count)
+            : _t {t}, _first {first}, _count {count} {}
+        public: inline int Count() const { return _count; }
+        public: inline bool Empty() const { return _count <= 0; }
+        public: inline Node operator[](int i) const
+        {
+            return Node {_t, _first + i};
+        }
+        public: inline Iterator begin() const { return {_t, _first}; }
+        public: inline Iterator end  () const { return {_t, _first + _count}; }
+        private: const FFDTable * _t;
+        private: int _first, _count;
+    };// Range
+
+    // A record of a table; the table must outlive it. The default one is
+    // "null": operator bool() is false.
+    public: class Node final
+    {
+        friend class FFDStructArray; // views the fixed-size struct ones
+        public: Node() {}
+        public: Node(const FFDTable * t, int i) : _t {t}, _i {i} {}
+        public: inline explicit operator bool() const { return nullptr != _t; }
+        public: inline bool operator==(const Node & v) const
+        {
+            return _t == v._t && _i == v._i;
+        }
+        public: inline int Index() const { return _i; }
+        public: inline FFD::SNode * FieldNode() const { return R ().Field; }
+        public: inline Node Parent() const
+        {
+            return R ().Parent < 0 ? Node {} : Node {_t, R ().Parent};
+        }
+        public: inline Range Nodes() const
+        {
+            return Range {_t, R ().First, R ().Count};
+        }
+        public: inline const byte * Data() const
+        {
+            return _t->_bytes.operator byte * () + R ().Data;
+        }
+        public: inline int Length() const { return R ().Length; }
+
+        public: inline bool IsEnum() const
+        {
+            FFD_ENSURE(nullptr != R ().DType, "No type info")
+            return R ().DType->IsEnum ();
+        }
+        public: inline const String & GetEnumName() const
+        {
+            int v = AsInt ();
+            auto found = R ().DType->EnumItems.Find (
+                [&v](const auto & itm) { return itm.Value == v; });
+            FFD_ENSURE(nullptr != found, "Unknown enum value")
+            return found->Name;
+        }
+        public: inline String AsString() const
+        {
+            return static_cast<String &&>(String {Data (), Length ()});
+        }
+        public: inline byte AsByte() const { return Data ()[0]; }
+        public: inline short AsShort() const
+        {
+            switch (Length ()) {
+                case 1: return static_cast<short>(Data ()[0]);
+                case 2: return As<short> ();
+                default: FFD_ENSURE(0, "Don't request that AsShort")
+            }
+        }
+        public: template <typename T> inline T As() const
+        {
+            return *(reinterpret_cast<const T *>(Data ()));
+        }
+        public: template <typename T> inline const T * AsArr() const
+        {
+            return reinterpret_cast<const T *>(Data ());
+        }
+        // Hash keys: the value at their hash table; see FFDNode::AsInt().
+        public: inline int AsInt() const
+        {
+            int result {};
+            switch (Length ()) {
+                case 1: result = static_cast<int>(As<byte> ()); break;
+                case 2: result = static_cast<int>(
+                    R ().Signed ? As<short> () : As<unsigned short> ());
+                    break;
+                case 4: result = As<int> (); break;
+                default: FFD_ENSURE(0, "Don't request that AsInt")
+            }
+            if (R ().HashKey) {
+                FFD_ENSURE(R ().Ht >= 0, "HashKey without a HashTable")
+                auto & ht = _t->_records[R ().Ht];
+                FFD_ENSURE(result >= 0 && result < ht.Count,
+                    "HashKey out of range")
+                return Node {_t, ht.First + result}.AsInt ();
+            }
+            return result;
+        }
+        public: inline Node NodeByName(const String & name) const
+        {
+            return NodeByName (NameId (name));
+        }
+        // See FFDNode::NameId().
+        public: inline int NameId(const String & name) const
+        {
+            auto names = FieldNode ()->Names;
+            return names ? names->IndexOf (name) : -1;
+        }
+        // The same lookup as FFDNode::NodeByName(): the fields of this one,
+        // then the ones of its parent, and so on.
+        public: inline Node NodeByName(int name_id) const
+        {
+            if (name_id < 0) return Node {};
+            for (int i = _i; i >= 0; i = _t->_records[i].Parent) {
+                auto & r = _t->_records[i];
+                if (r.Array) continue; // no point looking in it
+                for (int j = r.First; j < r.First + r.Count; j++)
+                    if (_t->_records[j].Field->NameId == name_id)
+                        return Node {_t, j};
+            }
+            return Node {};
+        }
+        // Returns "dt" if "nn" ain't present.
+        public: template <typename T> T Get(const String & nn, T dt = T {})
+            const
+        {
+            auto node = NodeByName (nn);
+            if (! node) return dt;
+            return static_cast<T>(node.AsInt ());
+        }
+        public: inline bool ArrayOfFields() const
+        {
+            return R ().Array && 0 == R ().ItemSize;
+        }
+        public: inline int NodeCount() const
+        {
+            return ArrayOfFields () ? R ().Count : Length () / R ().ItemSize;
+        }
+        public: inline Node operator[](int i) const
+        {
+            // the fixed-size struct items have no record: see FFDStructArray
+            FFD_ENSURE(ArrayOfFields (), "Pre-computed size: see "
+                "FFDStructArray")
+            return Node {_t, R ().First + i};
+        }
+        public: inline int IntArrElementAt(int index) const
+        {
+            auto dt = R ().DType;
+            FFD_ENSURE(dt != nullptr, "IntArrElementAt: DType can't be null")
+            FFD_ENSURE(dt->IsIntType (), "IntArrElementAt: not an int array")
+            switch (dt->Size) {
+                case 1: return AsArr<byte> ()[index];
+                case 2: return dt->Signed ? AsArr<short> ()[index]
+                    : AsArr<unsigned short> ()[index];
+                case 4: return dt->Signed ? AsArr<int>()[index]
+                    : AsArr<unsigned int>()[index];
+                default: FFD_ENSURE(0, "IntArrElementAt: unhandled DType->Size")
+            }
+        }
+        private: const FFDTable * _t {};
+        private: int _i {};
+        private: inline const Record & R() const { return _t->_records[_i]; }
+    };// Node
+
+    public: inline Node Root() const
+    {
+        return _records.Empty () ? Node {} : Node {this, 0};
+    }
+    public: inline int Count() const { return _records.Count (); }
+    public: inline const Record & operator[](int i) const
+    {
+        return _records[i];
+    }
+    public: inline const ByteArray & Bytes() const { return _bytes; }
+    // [bytes] the records and the data
+    public: inline size_t Size() const
+    {
+        return _records.Count () * sizeof(Record) + _bytes.Length ();
+    }
+
+    private: List<Record> _records {};
+    private: ByteArray _bytes {};
+};// FFDTable
+
+NAMESPACE_FFD
+
+#endif
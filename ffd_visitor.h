@@ -0,0 +1,76 @@
+/**** BEGIN LICENSE BLOCK ****
+
+BSD 3-Clause License
+
+Copyright (c) 2023, the wind.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+**** END LICENCE BLOCK ****/
+
+// The fields, in stream order, as they're parsed: File2Tree() calls one of
+// these instead of keeping a tree; see FFD::ParseContext::Visitor.
+
+#ifndef _FFD_VISITOR_H_
+#define _FFD_VISITOR_H_
+
+#include "ffd_model.h"
+#include "ffd.h"
+
+FFD_NAMESPACE
+
+// Usage:
+//   class Stats final : public FFDVisitor { ... };
+//   FFDProjection deps {ffd, List<String> {}}; // no paths
+//   FFD::ParseContext ctx {ffd};
+//   ctx.Projection = &deps, ctx.Visitor = &stats;
+//   FFD::FreeNode (ffd.File2Tree (s, ctx));
+// With a Projection, the FFDNode-s are made for what it keeps only - the
+// fields the data depend on, and its paths; the rest is visited and gone:
+// the structs on the stack, the data at the stream when it is a memory one
+// and at a buffer of the ParseContext otherwise. Leave the Arena null: what
+// it allocates is freed by FFDArena::Reset() only.
+// Without a Projection, the whole tree is built as well.
+// "field": FieldNode () of the FFDNode it would be; "data": valid during the
+// call only. Called by the thread calling File2Tree().
+class FFD_EXPORT FFDVisitor
+{
+    // A struct, or an item of an array of structs; its fields follow.
+    public: virtual void OnStructBegin(FFD::SNode * /*field*/) {}
+    public: virtual void OnStructEnd(FFD::SNode * /*field*/) {}
+    // A machine type or an enum: "len" bytes at "data".
+    public: virtual void OnField(FFD::SNode *, const byte *, int /*len*/) {}
+    // "count" items, "len" bytes at "data"; null for an array of structs -
+    // its items follow: OnStructBegin() ... OnStructEnd(), "count" times.
+    public: virtual void OnArray(FFD::SNode *, int /*count*/,
+        const byte *, int /*len*/) {}
+    public: virtual ~FFDVisitor() {}
+};// FFDVisitor
+
+NAMESPACE_FFD
+
+#endif
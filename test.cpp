@@ -47,8 +47,26 @@ static_assert(4 == sizeof(int), "I need 32-bit \"int\"");
 #include "ffd_dbg.h"
 #include "ffd.h"
 #include "ffd_node.h"
+#include "ffd_corpus.h"
+#include "ffd_arena.h"
+#include "ffd_table.h"
+#include "ffd_map_stream.h"
+#include "ffd_memory_stream.h"
+#include "ffd_projection.h"
+#include "ffd_visitor.h"
+#include "ffd_array_cursor.h"
+#include "ffd_struct_array.h"
+#include "ffd_array_view.h"
+#include "ffd_inflate_stream.h"
+#include "ffd_prefetch.h"
 #include <zlib.h>
 #include <new>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <pthread.h>
+#include <sched.h>
 
 #if FFD_TEST_N_FILE_STREAM
 #include "n_file_stream.h"
@@ -60,6 +78,20 @@ static_assert(4 == sizeof(int), "I need 32-bit \"int\"");
 static void test_the_list();
 static void test_the_string();
 static void test_the_byte_arr();
+static void test_the_precomputed_size();
+static void test_the_map_views();
+static void test_the_span_views();
+static void test_the_field_slots();
+static void test_the_table_struct_array();
+static void test_the_inflate();
+static void test_the_stop_field();
+static void test_the_byte_order();
+static void test_the_symbol_index();
+static void test_the_arena();
+static void test_the_prefetch();
+static void test_the_compile_path();
+static void test_the_image();
+static void bench_the_works();
 
 FFD_NAMESPACE
 #ifndef FFD_TEST_N_FILE_STREAM
@@ -110,6 +142,24 @@ class TestStream final : public Stream
         }
     }
     public: Stream & Reset() override { return Seek (-Tell ()); }
+    public: const byte * Peek(size_t b) override
+    {
+        if (b > static_cast<size_t>(_RBUF_SIZE)) return nullptr;
+        auto n = static_cast<int>(b), left = _rb_size - _rb_ptr;
+        if (left < n) { // what's left to the front; fill the rest
+            memmove (_rbuf, _rbuf + _rb_ptr, left);
+            _rb_ptr = 0, _rb_size = left + static_cast<int>(
+                fread (_rbuf + left, 1, _RBUF_SIZE - left, _f));
+            if (_rb_size < n) return nullptr;
+        }
+        return _rbuf + _rb_ptr;
+    }
+    public: const byte * Borrow(size_t b) override
+    {
+        auto result = Peek (b);
+        if (result) _rb_ptr += static_cast<int>(b);
+        return result;
+    }
     public: TestStream(const char * fn) : Stream {}, _f{fopen (fn, "rb")}
     {
         OS::Alloc (_rbuf, _RBUF_SIZE);
@@ -130,56 +180,6 @@ class TestStream final : public Stream
     private: int _rb_ptr{};
 };
 #endif
-class TestZipInflateStream final : public Stream
-{
-    private: z_stream _zs {};
-    private: int _zr {~Z_OK}, _size, _usize;
-    private: off_t _pos {}; // how many bytes were decoded so far
-    private: static uInt constexpr _IN_BUF {1<<12}; // zlib: uInt
-    private: byte _buf[_IN_BUF] {};
-    private: Stream * _s;
-    private: off_t _s0;
-    // The h3map one differs in init. No need to create another class.
-    public: TestZipInflateStream(Stream * s, int size, int usize,
-        bool h3map = false)
-        : Stream {}, _size{size}, _usize{usize}, _s{s}, _s0 {s->Tell ()}
-    {
-        if (h3map) _zr = inflateInit2 (&_zs, 31);
-        else _zr = inflateInit (&_zs);
-        FFD_ENSURE(Z_OK == _zr, "inflateInit() error")
-    }
-    public: ~TestZipInflateStream() override { inflateEnd (&_zs); }
-    public: inline operator bool() { return Z_OK == _zr; }
-    // You can use these for progress: 1.0 * Tell() / Size() * 100
-    public: off_t Tell() const override { return _pos; }; // uncompressed
-    public: off_t Size() const override { return _usize; }; // uncompressed
-    public: Stream & Read(void * buf, size_t bytes = 1) override
-    {
-        // Dbg << "ZRead(" << buf << ", " << bytes << ")" << EOL;
-        FFD_ENSURE(bytes > 0, "bytes can't be <= 0")
-        FFD_ENSURE(nullptr != buf, "buf can't be null")
-        // The sheer elegance of z_stream is impressive.
-        _zs.avail_out = static_cast<uInt>(bytes); // zlib: uInt
-        _zs.next_out = static_cast<z_const Bytef *>(buf);
-        while (_zs.avail_out > 0) {
-            if (_zs.avail_in <= 0) {
-                _zs.avail_in = static_cast<uInt>(_size - (_s->Tell () - _s0));
-                FFD_ENSURE(_zs.avail_in > 0, "TestZIStream::Read no more input")
-                if (_zs.avail_in > _IN_BUF) _zs.avail_in = _IN_BUF;
-                _s->Read (_buf, _zs.avail_in);
-                _zs.next_in = static_cast<z_const Bytef *>(_buf);
-            }
-            auto sentinel1 = _zs.avail_in;
-            auto sentinel2 = _zs.avail_out;
-            _zr = inflate (&_zs, Z_SYNC_FLUSH);
-            if (Z_STREAM_END == _zr) _zr = Z_OK;
-            FFD_ENSURE(Z_OK == _zr, "TestZIStream::Read error")
-            FFD_ENSURE(sentinel1 != _zs.avail_in || sentinel2 != _zs.avail_out,
-                "TestZIStream::Read infinite loop case")
-        }
-        return _pos += bytes, *this;
-    } // Read()
-};// TestZipInflateStream
 NAMESPACE_FFD
 
 namespace __pointless_verbosity
@@ -192,10 +192,9 @@ namespace __pointless_verbosity
     };
 }
 
-static void parse_h3m(FFD_NS::FFD &, const char *);
-static void parse_nif(FFD_NS::FFD &, const char *);
+using ParseContext = FFD_NS::FFD::ParseContext;
 static void parse_directory(FFD_NS::FFD &, const char *, const char *,
-    void (*)(FFD_NS::FFD &, const char *), bool = false);
+    bool h3m = false);
 
 // usage: test ffd dir ext_list(a,b,c,...)
 // what does it do: are_equal(data, Tree2File (File2Tree (ffd, data))
@@ -210,6 +209,21 @@ int main(int argc, char ** argv)
         test_the_list ();
         test_the_string ();
         test_the_byte_arr ();
+        test_the_precomputed_size ();
+        test_the_map_views ();
+        test_the_span_views ();
+        test_the_field_slots ();
+        test_the_table_struct_array ();
+        test_the_inflate ();
+        test_the_stop_field ();
+        test_the_byte_order ();
+        test_the_symbol_index ();
+        test_the_arena ();
+        test_the_prefetch ();
+        test_the_compile_path ();
+        test_the_image ();
+        if (2 == argc && ! strcmp ("bench", argv[1]))
+            return bench_the_works (), 0;
         if (4 != argc)
             return Dbg << "usage: test ffd/dir nif_dir ext_list(a,b,c,...)"
                 << EOL, 0;
@@ -231,10 +245,13 @@ int main(int argc, char ** argv)
         Dbg.Enabled = false;
 #endif
             FFD_NS::FFD ffd {ffd_buf.operator byte * (), ffd_buf.Length ()};
+#ifdef FFD_TEST_COMPILE
+            ffd.Compile ();
+#endif
             if (ffd.GetAttr ("[Stream(type: zlibMapStream)]"))
-                return parse_directory (ffd, argv[2], argv[3], parse_h3m), 0;
+                return parse_directory (ffd, argv[2], argv[3], true), 0;
             else if (FFD_NS::OS::IsDirectory (argv[2])) {
-                parse_directory (ffd, argv[2], argv[3], parse_nif);
+                parse_directory (ffd, argv[2], argv[3]);
                 auto prev = Dbg.Enabled;
                     Dbg.Enabled = true;
                     ffd.Head ()->WalkForward ([](FFD_NS::FFD::SNode * n) {
@@ -247,140 +264,170 @@ int main(int argc, char ** argv)
     return 0;
 }// main()
 
-// you manage the returned pointer
-static char * CatPath(const char * a, const char * b)
-{
-    char * r{};
-    auto l1 = FFD_NS::OS::Strlen (a);
-    auto l2 = 1;
-    auto l3 = FFD_NS::OS::Strlen (b);
-    FFD_NS::OS::Alloc (r, l1+l2+l3+1);
-    FFD_NS::OS::Memcpy (r, a, l1);
-    r[l1] = FFD_PATH_SEPARATOR;
-    FFD_NS::OS::Memcpy (r+l1+l2, b, l3);
-    return r;
-}
-// naive find the text after the last '.' in "n" - in "m"; m - list: a,b,c,...
-static bool MaskMatch(const char * n, const char * m)
-{
-    auto ln = FFD_NS::OS::Strlen (n);
-    for (int i = ln-1 ; i >= 0; i--)
-        if ('.' == n[i] && i < static_cast<int>(ln-1))
-            if (strcasestr (m, n+i+1)) return true;
-    return false;
-}
-// a recursive one
-template <typename T> void enum_files(T t, const char * d, const char * m)
-{
-    FFD_NS::OS::EnumFiles (d, [&](const char * n, bool directory)
-        {
-            auto fp = CatPath (d, n);
-            FFD_NS::OS::__pointless_verbosity::__try_finally_free<char> _ {fp};
-            if (directory) enum_files (t, fp, m);
-            else if (MaskMatch (n, m)) t (fp);
-            return true;
-        });
-}
-
-// the files that can not be parsed yet are renamed to .nop
+// One stream per worker; parse_nif and parse_h3m, as FFDCorpus::Client.
+// The files that can not be parsed yet are skipped.
 //TODO the misaligned blocks are a primary issue - how to specify the parser
 //     to use nif.BlockSize?!
-// broken files are renamed to .bro
-void parse_nif(FFD_NS::FFD & ffd, const char * n)
+class TestCorpusClient final : public FFD_NS::FFDCorpus::Client
 {
+    using SIMPLY_STREAM = FFD_NS::Stream;
+    using SIMPLY_ZSTREAM = FFD_NS::FFDInflateStream;
+    using MEMORY_STREAM = FFD_NS::FFDMemoryStream;
+    using FILE_STREAM = FFD_STREAM;
+    public: TestCorpusClient(int workers, int files, bool h3m, bool trace)
+        : _files {files}, _h3m {h3m}, _trace {trace}
+    {
+        for (int i = 0; i < workers; i++)
+            _file.Add (nullptr), _z.Add (nullptr);
+    }
+    public: ~TestCorpusClient() override
+    {
+        for (int i = 0; i < _file.Count (); i++) Close (i);
+    }
+    public: SIMPLY_STREAM * Open(int worker, const char * n) override
+    {
+        // a trace is serial: the header goes before it
+        if (_trace)
+            Dbg << Dbg.Fmt ("[%6d", ++_parsed) << Dbg.Fmt ("/%6d]: ", _files)
+                << n << EOL;
+        Close (worker);
+        auto & s = *(_file[worker] = OpenFile (n));
+        return _h3m ? OpenH3m (worker, s) : OpenNif (s);
+    }
+    // FFDCorpus::Prefetch()
+    public: SIMPLY_STREAM * Opened(int worker, const char * n,
+        MEMORY_STREAM & data) override
+    {
+        if (_trace)
+            Dbg << Dbg.Fmt ("[%6d", ++_parsed) << Dbg.Fmt ("/%6d]: ", _files)
+                << n << EOL;
+        Close (worker);
+        return _h3m ? OpenH3m (worker, data) : OpenNif (data);
+    }
+    public: void Parsed(const FFD_NS::FFDCorpus::Result & r) override
+    {
+        // Dbg is off while the corpus runs untraced; the report is not
+        if (! _trace) {
+            printf ("[%6d/%6d]: %s" EOL, ++_parsed, _files, r.FileName);
+            if (_h3m) PrintH3mSizes (r.FileName);
+        }
+        if (r.Skipped) {
+            printf ("Unsupported Version\n");
+            Todo++;
+        }
+        auto * tree = r.Tree;
+        if (nullptr == tree) return;
+        // tree->PrintTree ();
+        if (_h3m)
+            printf (", unprocessed h3m stream bytes: %lu" EOL,
+                static_cast<unsigned long>(r.Unread));
+    }
+    public: int Todo {};
+
+    // filter by version
+    private: SIMPLY_STREAM * OpenNif(SIMPLY_STREAM & data_stream)
+    {
+        int const BUF_SIZE{64}; byte tmp[BUF_SIZE] {};
+        auto buf = data_stream.Peek (BUF_SIZE);
+        if (nullptr == buf)
+            data_stream.Read (tmp, BUF_SIZE).Reset (), buf = tmp;
+        const char * fv = "20.2.0.7"; int fvl = 8;
+        for (int i = 0; i < BUF_SIZE; i++)
+            if ('\n' == buf[i]) {
+                int l = i-fvl;
+                if (l < 0) { printf ("(not a nif file)"); return nullptr; }
+                if (! (0 == memcmp (buf+l, fv, fvl))) return nullptr;
+                break;
+            }
+            else if (buf[i] < 32 || buf[i] > 127) {
+                printf ("(not a nif file)");
+                return nullptr;
+            }
+        return &data_stream;
+    }
+    private: SIMPLY_STREAM * OpenH3m(int worker, SIMPLY_STREAM & h3m_stream)
+    {
+        // 6167 maps: the largest: 375560 bytes, uncompressed one: 1342755 bytes
+        const int H3M_MAX_FILE_SIZE = 1<<21;
+        int h, usize{}, size = static_cast<int>(h3m_stream.Size ());
+        if (_trace) printf ("(%d bytes)", size);
+        FFD_ENSURE(size > 3 && size < H3M_MAX_FILE_SIZE,
+            "Suspicious Map size")
+        h3m_stream.Read (&h, 4).Reset ();
+        if (0x88b1f != h) return &h3m_stream;
+        // zlibMapStream
+        h3m_stream.Seek (size - 4).Read (&usize, 4).Reset ();
+        if (_trace) printf (", USize: %d bytes", usize);
+        FFD_ENSURE(usize > size && usize < H3M_MAX_FILE_SIZE,
+            "Suspicious Map usize")
+        // inflated by a thread while it is parsed
+        FFD_CREATE_OBJECT(_z[worker], SIMPLY_ZSTREAM) {&h3m_stream, size,
+            usize, /*gzip:*/true};
+        return _z[worker];
+    }
+    private: static FILE_STREAM * OpenFile(const char * n)
+    {
+        FILE_STREAM * f {};
 #ifdef FFD_TEST_N_FILE_STREAM
-    FFD_STREAM data_stream {QString::fromLocal8Bit (n)};
+        FFD_CREATE_OBJECT(f, FILE_STREAM) {QString::fromLocal8Bit (n)};
 #else
-    FFD_STREAM data_stream {n};
+        FFD_CREATE_OBJECT(f, FILE_STREAM) {n};
 #endif
-    // filter by version
-    int const BUF_SIZE{64}; byte buf[BUF_SIZE] {};
-    data_stream.Read (buf, BUF_SIZE).Reset ();
-    const char * fv = "20.2.0.7"; int fvl = 8;
-    for (int i = 0; i < BUF_SIZE; i++)
-        if ('\n' == buf[i]) {
-            int l = i-fvl;
-            if (l < 0) { printf ("(not a nif file)"); return; }
-            if (! (0 == memcmp (buf+l, fv, fvl))) return;
-            break;
-        }
-        else if (buf[i] < 32 || buf[i] > 127) {
-            printf ("(not a nif file)");
-            return;
+        return f;
+    }
+    // What OpenH3m() prints when tracing; the workers were not asked to.
+    private: static void PrintH3mSizes(const char * n)
+    {
+        auto * f = OpenFile (n);
+        int h {}, usize {}, size = static_cast<int>(f->Size ());
+        printf ("(%d bytes)", size);
+        if (size > 3) {
+            f->Read (&h, 4).Reset ();
+            if (0x88b1f == h) {
+                f->Seek (size - 4).Read (&usize, 4).Reset ();
+                printf (", USize: %d bytes", usize);
+            }
         }
+        FFD_DESTROY_OBJECT(f, FILE_STREAM)
+    }
+    private: void Close(int worker)
+    {
+        FFD_DESTROY_OBJECT(_z[worker], SIMPLY_ZSTREAM)
+        _z[worker] = nullptr;
+        FFD_DESTROY_OBJECT(_file[worker], FILE_STREAM)
+        _file[worker] = nullptr;
+    }
+    private: int _files, _parsed {};
+    private: bool _h3m, _trace;
+    private: FFD_NS::List<FILE_STREAM *> _file {};
+    private: FFD_NS::List<SIMPLY_ZSTREAM *> _z {};
+};// TestCorpusClient
 
-    FFD_NS::FFDNode * tree = ffd.File2Tree (data_stream);
-    FFD_ENSURE(nullptr != tree, "parse_nif(): File2Tree() returned null?!")
-    // tree->PrintTree ();
-    ffd.FreeNode (tree);
-}
-
+// Q: all CPUs; otherwise one worker - the trace output needs serial order.
 void parse_directory(FFD_NS::FFD & ffd, const char * r, const char * m,
-    void (*pp)(FFD_NS::FFD &, const char *), bool no)
+    bool h3m)
 {
     Dbg.Enabled = true;
     Dbg << "parse_directory \"" << r << "\", mask: \"" << m << "\"" << EOL;
     Dbg << "Enumerating, please wait ... ";
-    int files{}, todo{}, tfiles{};
-    enum_files ([&](const char *) { tfiles++; }, r, m); Dbg << "done" << EOL;
-    enum_files ([&](const char * n)
-        {
-            Dbg << Dbg.Fmt ("[%6d", ++files) << Dbg.Fmt ("/%6d]: ", tfiles)
-                << n << EOL;
-#ifdef FFD_QTEST
-            Dbg.Enabled = no ? Dbg.Enabled : false;
-#endif
-            ffd.Invalidate ();
-            pp (ffd, n);
 #ifdef FFD_QTEST
-            Dbg.Enabled = no ? Dbg.Enabled : true;
+    FFD_NS::FFDCorpus corpus {ffd};
+    bool trace {false};
+#else
+    FFD_NS::FFDCorpus corpus {ffd, 1};
+    bool trace {true};
 #endif
-            if (FFD_NS::FFDNode::SkipAnnoyngFile) {
-                FFD_NS::FFDNode::SkipAnnoyngFile = false;
-                printf ("Unsupported Version\n");
-                todo++;
-            }
-        }, r, m);
-    Dbg << "parsed: " << files; if (todo) Dbg << " (todo: " << todo << ")";
+    corpus.AddDirectory (r, m); Dbg << "done" << EOL;
+    corpus.Prefetch (8);
+    TestCorpusClient client {corpus.Workers (), corpus.Count (), h3m, trace};
+    Dbg.Enabled = trace;
+        corpus.Run (client, /*ordered:*/true);
+    Dbg.Enabled = true;
+    Dbg << "parsed: " << corpus.Count ();
+    if (client.Todo) Dbg << " (todo: " << client.Todo << ")";
     Dbg << EOL;
 }
 
-void parse_h3m(FFD_NS::FFD & ffd, const char * map)
-{
-    using SIMPLY_STREAM = FFD_NS::Stream;
-    using SIMPLY_ZSTREAM = FFD_NS::TestZipInflateStream;
-#ifdef FFD_TEST_N_FILE_STREAM
-    FFD_STREAM h3m_stream {QString::fromLocal8Bit (map)};
-#else
-    FFD_STREAM h3m_stream {map};
-#endif
-    SIMPLY_STREAM * data_stream {&h3m_stream};
-    // 6167 maps: the largest: 375560 bytes, uncompressed one: 1342755 bytes
-    const int H3M_MAX_FILE_SIZE = 1<<21;
-    int h, usize{}, size = static_cast<int>(h3m_stream.Size ());
-    printf ("(%d bytes)", size);
-    FFD_ENSURE(size > 3 && size < H3M_MAX_FILE_SIZE,
-        "Suspicious Map size")
-    h3m_stream.Read (&h, 4).Reset ();
-    if (0x88b1f == h) { // zlibMapStream
-        h3m_stream.Seek (size - 4).Read (&usize, 4).Reset ();
-        printf (", USize: %d bytes", usize);
-        FFD_ENSURE(usize > size && usize < H3M_MAX_FILE_SIZE,
-            "Suspicious Map usize")
-        FFD_CREATE_OBJECT(data_stream, SIMPLY_ZSTREAM) {
-            &h3m_stream, size, usize, /*h3map:*/true};
-    }
-
-    __pointless_verbosity::__try_finally_free_the_object<SIMPLY_STREAM> __ {
-        &h3m_stream != data_stream ? data_stream : nullptr};
-    auto * tree = ffd.File2Tree (*data_stream);
-    FFD_ENSURE(nullptr != tree, "parse_nif(): File2Tree() returned null?!")
-    // tree->PrintTree ();
-    ffd.FreeNode (tree);
-    printf (", unprocessed h3m_stream bytes: %lu" EOL,
-        h3m_stream.Size () - h3m_stream.Tell ());
-}// parse_h3m()
-
 // __ testworks ________________________________________________________________
 static const char * TEST_NAME = "";
 #define ARE_EQUAL(A,B,M) FFD_ENSURE((A) == (B), M) \
@@ -582,3 +629,2058 @@ void test_the_byte_arr()
     ARE_EQUAL(1, a.Length (), "length is not 1")
     ARE_EQUAL(1, a[0], "unexpected element[0]")
 }// test_the_byte_arr()
+
+// The struct named "n" of "ffd".
+static FFD_NS::FFD::SNode * test_struct(FFD_NS::FFD & ffd, const char * n)
+{
+    FFD_NS::FFD::SNode * result {};
+    ffd.Head ()->WalkForward ([&](FFD_NS::FFD::SNode * node) {
+        if (node->IsStruct () && node->Name == n) result = node;
+        return nullptr == result;
+    });
+    return result;
+}
+
+void test_the_precomputed_size()
+{
+    TEST_NAME="SNode.PrecomputeSize()";
+    const char d[] = "type byte 1" EOL "const N 4" EOL EOL
+        "struct Fixed" EOL "    byte A" EOL "    byte B[N]" EOL EOL
+        "struct Sized" EOL "    byte Len" EOL "    byte Data[Len]" EOL EOL
+        "format F" EOL "    Fixed X" EOL "    Sized Y" EOL;
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    auto fixed = test_struct (ffd, "Fixed"), sized = test_struct (ffd, "Sized");
+    IS_NOT_NULL(fixed, "no struct Fixed")
+    IS_NOT_NULL(sized, "no struct Sized")
+    ARE_EQUAL(5, fixed->PrecomputeSize (), "wrong fixed size")
+    // "Len" is a field: no root symbol resolves it - it was taken for 1
+    IS_ZERO(sized->PrecomputeSize (), "an unresolved dimension is fixed")
+}// test_the_precomputed_size()
+
+// Views: B and C are at odd offsets - read as arrays of their type anyway.
+static const char TEST_PACKED[] = "type byte 1" EOL "type short 2" EOL
+    "type int 4" EOL EOL "format F" EOL "    byte A" EOL "    short B[2]" EOL
+    "    int C[2]" EOL;
+alignas(8) static const byte TEST_PACKED_DATA[] {7, 2, 0, 44, 1, 1, 0, 0, 0,
+    0x40, 0x42, 0x0f, 0};
+static void test_packed(FFD_NS::FFDNode * root)
+{
+    IS_NOT_NULL(root, "no tree")
+    auto b = root->NodeByName ("B"), c = root->NodeByName ("C");
+    IS_NOT_NULL(b, "no B")
+    IS_NOT_NULL(c, "no C")
+    ARE_EQUAL(2, b->IntArrElementAt (0), "wrong B[0]")
+    ARE_EQUAL(300, b->IntArrElementAt (1), "wrong B[1]")
+    ARE_EQUAL(302, b->IntArrElementSum (), "wrong B sum")
+    ARE_EQUAL(1, c->IntArrElementAt (0), "wrong C[0]")
+    ARE_EQUAL(1000000, c->IntArrElementAt (1), "wrong C[1]")
+    ARE_EQUAL(1000001, c->IntArrElementSum (), "wrong C sum")
+    auto p = c->AsArr<int> ();
+    IS_ZERO(reinterpret_cast<uintptr_t>(p) % alignof(int), "AsArr: misaligned")
+    ARE_EQUAL(1000000, p[1], "wrong AsArr<int> ()[1]")
+}
+
+void test_the_map_views()
+{
+    TEST_NAME="FFDMapStream views";
+    char n[] = "/tmp/ffd_test_XXXXXX";
+    int fd = mkstemp (n);
+    IS_TRUE(fd >= 0, "mkstemp() failed")
+    bool written = sizeof(TEST_PACKED_DATA) == write (fd, TEST_PACKED_DATA,
+        sizeof(TEST_PACKED_DATA));
+    close (fd);
+    IS_TRUE(written, "write() failed")
+    {
+        FFD_NS::FFD ffd {reinterpret_cast<const byte *>(TEST_PACKED),
+            sizeof(TEST_PACKED) - 1};
+        FFD_NS::FFDMapStream s {n};
+        IS_TRUE(static_cast<bool>(s), "can't map it")
+        ParseContext ctx {ffd};
+        ctx.Map = &s;
+        auto root = ffd.File2Tree (s, ctx);
+        test_packed (root);
+        FFD_NS::FFD::FreeNode (root);
+    }
+    unlink (n);
+}// test_the_map_views()
+
+// Compiled: A, B and C are one Span - B and C are views into it.
+void test_the_span_views()
+{
+    TEST_NAME="FFDProgram Span views";
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(TEST_PACKED),
+        sizeof(TEST_PACKED) - 1};
+    ffd.Compile ();
+    FFD_NS::FFDMemoryStream s {TEST_PACKED_DATA, sizeof(TEST_PACKED_DATA)};
+    auto root = ffd.File2Tree (s);
+    test_packed (root);
+    FFD_NS::FFD::FreeNode (root);
+}// test_the_span_views()
+
+// By NameId: a name twice, and a composite field named as a later one.
+static const char TEST_SLOTS[] = "type byte 1" EOL EOL "struct Vec" EOL
+    "    byte X" EOL "    byte Y" EOL EOL "format F" EOL "    byte K" EOL
+    "    byte V (K == 1)" EOL "    byte V (K == 2)" EOL "    Vec" EOL
+    "    byte X" EOL;
+static void test_slots(FFD_NS::FFD & ffd, byte k)
+{
+    const byte data[] {k, 5, 6, 7, 8};
+    FFD_NS::FFDMemoryStream s {data, sizeof(data)};
+    auto root = ffd.File2Tree (s);
+    IS_NOT_NULL(root, "no tree")
+    ARE_EQUAL(5, root->Nodes ().Count (), "wrong field count")
+    ARE_EQUAL(k, root->NodeByName ("K")->AsInt (), "wrong K")
+    ARE_EQUAL(5, root->NodeByName ("V")->AsInt (), "wrong V")
+    ARE_EQUAL(6, root->NodeByName ("X")->AsInt (), "not the 1st X")
+    ARE_EQUAL(7, root->NodeByName ("Y")->AsInt (), "wrong Y")
+    IS_NULL(root->NodeByName ("Z"), "a Z out of nowhere")
+    FFD_NS::FFD::FreeNode (root);
+}
+
+void test_the_field_slots()
+{
+    TEST_NAME="FFDNode.NodeByName() by slot";
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(TEST_SLOTS),
+        sizeof(TEST_SLOTS) - 1};
+    auto f = test_struct (ffd, "F");
+    IS_NOT_NULL(f, "no format F")
+    ARE_EQUAL(4, f->SlotCount, "wrong slot count")
+    test_slots (ffd, 1), test_slots (ffd, 2);
+    ffd.Compile ();
+    test_slots (ffd, 1), test_slots (ffd, 2);
+}// test_the_field_slots()
+
+// The fixed-size struct items of an FFDTable: through FFDStructArray.
+void test_the_table_struct_array()
+{
+    TEST_NAME="FFDStructArray of an FFDTable";
+    const char d[] = "type byte 1" EOL "type short 2" EOL EOL "struct Vec"
+        EOL "    byte X" EOL "    short Y" EOL EOL "format F" EOL
+        "    byte N" EOL "    Vec V[N]" EOL "    byte Z" EOL;
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    const byte data[] {2, 1, 2, 0, 3, 4, 1, 9};
+    FFD_NS::FFDMemoryStream s {data, sizeof(data)};
+    auto root = ffd.File2Tree (s);
+    IS_NOT_NULL(root, "no tree")
+    FFD_NS::FFDTable table {root};
+    FFD_NS::FFD::FreeNode (root);
+    auto t = table.Root ();
+    ARE_EQUAL(9, t.NodeByName ("Z").AsInt (), "wrong Z")
+    IS_FALSE(static_cast<bool>(t.NodeByName ("W")), "a W out of nowhere")
+    auto v = t.NodeByName ("V");
+    IS_FALSE(v.ArrayOfFields (), "V: not of fixed-size items")
+    ARE_EQUAL(2, v.NodeCount (), "wrong item count")
+    FFD_NS::FFDStructArray a {v};
+    ARE_EQUAL(2, a.Count (), "wrong FFDStructArray count")
+    ARE_EQUAL(3, a.Stride (), "wrong FFDStructArray stride")
+    int x = a.IndexOf ("X"), y = a.IndexOf ("Y");
+    ARE_EQUAL(1, a.AsInt (0, x), "wrong V[0].X")
+    ARE_EQUAL(2, a.AsInt (0, y), "wrong V[0].Y")
+    ARE_EQUAL(3, a.AsInt (1, x), "wrong V[1].X")
+    ARE_EQUAL(260, a.AsInt (1, y), "wrong V[1].Y")
+}// test_the_table_struct_array()
+
+// A read-until array to the end: not found - it stops where the data do.
+static void test_inflate(FFD_NS::FFD & ffd, const FFD_NS::ByteArray & gz,
+    int len, int usize)
+{
+    FFD_NS::FFDMemoryStream gs {gz.operator byte * (),
+        static_cast<size_t>(gz.Length ())};
+    FFD_NS::FFDInflateStream s {&gs, gz.Length (), usize, true};
+    auto size = s.Size (); // it doesn't wait: either one
+    IS_TRUE(size == len || size >= usize, "Size(): not the bound")
+    auto root = ffd.File2Tree (s);
+    IS_NOT_NULL(root, "no tree")
+    auto text = root->NodeByName ("Text")->AsByteArray ();
+    ARE_EQUAL(len - 4, text->Length (), "wrong Text")
+    ARE_EQUAL(len, s.Tell (), "not all data read")
+    ARE_EQUAL(len, s.Inflated (), "wrong inflated size")
+    ARE_EQUAL(len, s.Size (), "Size(): not what it came to")
+    FFD_NS::FFD::FreeNode (root);
+}
+
+void test_the_inflate()
+{
+    TEST_NAME="FFDInflateStream";
+    const char d[] = "type byte 1" EOL "type int 4" EOL EOL "format F" EOL
+        "    int Count" EOL "    byte Text[-10]" EOL;
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    FFD_NS::ByteArray data {}, gz {};
+    int const len = 200004;
+    data.Resize (len);
+    for (int i = 4; i < len; i++) data[i] = 'a' + (i * 7 + i / 13) % 26;
+    z_stream zs {};
+    IS_TRUE(Z_OK == deflateInit2 (&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+        31, 8, Z_DEFAULT_STRATEGY), "deflateInit2() failed")
+    gz.Resize (static_cast<int>(deflateBound (&zs, len)));
+    zs.next_in = data.operator byte * (), zs.avail_in = len;
+    zs.next_out = gz.operator byte * (), zs.avail_out = gz.Length ();
+    IS_TRUE(Z_STREAM_END == deflate (&zs, Z_FINISH), "deflate() failed")
+    gz.Resize (static_cast<int>(zs.total_out));
+    deflateEnd (&zs);
+    test_inflate (ffd, gz, len, len);
+    test_inflate (ffd, gz, len, len / 5); // grows thrice
+    test_inflate (ffd, gz, len, 3 * len); // Size() is a bound till the end
+}// test_the_inflate()
+
+// SNode::StopsParsing(): walked, compiled, projected away - it stops anyway.
+void test_the_stop_field()
+{
+    TEST_NAME="SNode.StopsParsing()";
+    const char d[] = "type byte 1" EOL "type short 2" EOL EOL "format F" EOL
+        "    byte A" EOL "    short UVersion2" EOL "    byte B" EOL;
+    const byte data[] {1, FFD_NS::FFD::SNode::STOP_VALUE, 0, 2};
+    FFD_NS::FFD walk {reinterpret_cast<const byte *>(d), sizeof(d) - 1},
+        compiled {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    compiled.Compile ();
+    FFD_NS::List<FFD_NS::String> paths {};
+    paths.Add ("B");
+    for (int i = 0; i < 4; i++) {
+        FFD_NS::FFD & ffd = i & 1 ? compiled : walk;
+        FFD_NS::FFDProjection projection {ffd, paths};
+        ParseContext ctx {ffd};
+        if (i & 2) ctx.Projection = &projection;
+        FFD_NS::FFDMemoryStream s {data, sizeof(data)};
+        auto root = ffd.File2Tree (s, ctx);
+        IS_NOT_NULL(root, "no tree")
+        IS_TRUE(ctx.Skip, "it didn't stop")
+        ARE_EQUAL(3, s.Tell (), "it read past the stop")
+        IS_NULL(root->NodeByName ("B"), "B past the stop")
+        FFD_NS::FFD::FreeNode (root);
+    }
+}// test_the_stop_field()
+
+// The attribute is global: after the types, it is theirs too.
+void test_the_byte_order()
+{
+    TEST_NAME="[ByteOrder()]";
+    const char d[] = "type byte 1" EOL "type short 2" EOL
+        "type int 4 little" EOL EOL "format F" EOL "    short A" EOL
+        "    int B" EOL EOL "[ByteOrder(big)]" EOL;
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    const byte data[] {1, 2, 3, 0, 0, 0};
+    FFD_NS::FFDMemoryStream s {data, sizeof(data)};
+    auto root = ffd.File2Tree (s);
+    IS_NOT_NULL(root, "no tree")
+    ARE_EQUAL(0x102, root->NodeByName ("A")->AsInt (), "A: not big-endian")
+    ARE_EQUAL(3, root->NodeByName ("B")->AsInt (), "B: not its own order")
+    FFD_NS::FFD::FreeNode (root);
+}// test_the_byte_order()
+
+// "resolve: pass 1" of a field of the struct being parsed: the nearest one
+// backwards is that struct - not an earlier one of the same name.
+void test_the_symbol_index()
+{
+    TEST_NAME="FFD symbol index";
+    const char d[] = "type byte 1" EOL EOL "struct A" EOL "    byte X" EOL EOL
+        "struct A" EOL "    byte N" EOL "    A Self (N == 2)" EOL EOL
+        "format F" EOL "    A Top" EOL;
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    FFD_NS::FFD::SNode * a[2] {};
+    int n {};
+    ffd.Head ()->WalkForward ([&](FFD_NS::FFD::SNode * node) {
+        if (node->IsStruct () && node->Name == "A") a[n++] = node;
+        return n < 2;
+    });
+    IS_NOT_NULL(a[1], "no 2nd struct A")
+    ARE_EQUAL(a[1], a[1]->Fields[1]->DType, "Self: not of the 2nd A")
+    const byte data[] {2, 0};
+    FFD_NS::FFDMemoryStream s {data, sizeof(data)};
+    auto root = ffd.File2Tree (s);
+    IS_NOT_NULL(root, "no tree")
+    auto self = root->NodeByName ("Top")->NodeByName ("Self");
+    IS_NOT_NULL(self, "no Top.Self")
+    ARE_EQUAL(a[1], self->FieldNode ()->DType, "Top.Self: not of the 2nd A")
+    ARE_EQUAL(2, s.Tell (), "wrong Top.Self size")
+    FFD_NS::FFD::FreeNode (root);
+}// test_the_symbol_index()
+
+struct TestCleanup final { int * Calls; int Order; };
+static void test_arena_cleanup(void * p)
+{
+    auto c = static_cast<TestCleanup *>(p);
+    c->Order = ++*(c->Calls);
+}
+
+void test_the_arena()
+{
+    TEST_NAME="FFDArena";
+    FFD_NS::FFDArena a {256};
+    auto p = static_cast<byte *>(a.Alloc (10));
+    IS_ZERO(reinterpret_cast<uintptr_t>(p) % 16, "Alloc(): misaligned")
+    memset (p, 0x5a, 10);
+    ARE_EQUAL(16u, a.Used (), "Alloc(): not rounded up to 16")
+    auto q = a.Alloc (32);
+    ARE_EQUAL(q, a.Grow (q, 32, 64), "Grow(): the last one, not in place")
+    ARE_EQUAL(256u, a.Reserved (), "Grow(): in place, yet a new block")
+    // spill: larger than a block - a block of its own
+    auto big = a.Alloc (1000);
+    ARE_EQUAL(256u + 1008, a.Reserved (), "Alloc(): wrong spill block")
+    auto g = static_cast<byte *>(a.Grow (p, 10, 40));
+    IS_TRUE(g != p, "Grow(): not the last one, yet in place")
+    ARE_EQUAL(0x5a, g[9], "Grow(): not copied")
+    IS_TRUE(a.Owns (p) && a.Owns (big) && a.Owns (g), "Owns(): its own")
+    int local {};
+    IS_FALSE(a.Owns (&local), "Owns(): the stack")
+    int calls {};
+    TestCleanup c1 {&calls, 0}, c2 {&calls, 0};
+    a.AtReset (test_arena_cleanup, &c1);
+    a.AtReset (test_arena_cleanup, &c2);
+    auto peak = a.Used (), reserved = a.Reserved ();
+    IS_TRUE(reserved > 256u + 1008, "a 3rd block wasn't made")
+    a.Reset ();
+    ARE_EQUAL(2, calls, "AtReset(): not called twice")
+    IS_TRUE(1 == c2.Order && 2 == c1.Order, "AtReset(): not in reverse")
+    IS_ZERO(a.Used (), "Reset(): Used() != 0")
+    ARE_EQUAL(peak, a.Peak (), "Reset(): the peak is lost")
+    // spilled: one block for all of it, next time
+    ARE_EQUAL(reserved, a.Reserved (), "Reset(): not one block of it all")
+    auto again = a.Alloc (peak);
+    IS_TRUE(a.Owns (again), "Owns(): after Reset()")
+    ARE_EQUAL(reserved, a.Reserved (), "Reset(): the block is too small")
+    a.Reset ();
+    ARE_EQUAL(2, calls, "AtReset(): called again")
+    ARE_EQUAL(reserved, a.Reserved (), "Reset(): no spill, yet a new block")
+}// test_the_arena()
+
+// A file, one that is missing, a directory and an empty file: the ones that
+// can't be read are null, in Add() order, with their tags.
+void test_the_prefetch()
+{
+    TEST_NAME="FFDPrefetch";
+    char f[] = "/tmp/ffd_test_XXXXXX", e[] = "/tmp/ffd_test_XXXXXX";
+    int fd = mkstemp (f), ed = mkstemp (e);
+    IS_TRUE(fd >= 0 && ed >= 0, "mkstemp() failed")
+    bool written = 3 == write (fd, "abc", 3);
+    close (fd), close (ed);
+    IS_TRUE(written, "write() failed")
+    const char * names[] {f, "/tmp/ffd_test_no_such_file", "/tmp", e};
+    for (bool uring : {false, true}) {
+        FFD_NS::FFDPrefetch p {3, uring};
+        for (int i = 0; i < 3; i++) IS_TRUE(p.Add (names[i], 10 + i), "Add()")
+        IS_FALSE(p.Add (names[3], 13), "Add(): past Depth()")
+        ARE_EQUAL(3, p.Count (), "wrong Count()")
+        auto s = p.Next ();
+        IS_NOT_NULL(s, "Next(): a file")
+        ARE_EQUAL(10, p.Tag (), "wrong Tag()")
+        ARE_EQUAL(3, s->Size (), "wrong Size()")
+        IS_ZERO(memcmp (s->Data (), "abc", 3), "wrong data")
+        IS_TRUE(p.Add (names[3], 13), "Add(): after Next()")
+        IS_NULL(p.Next (), "Next(): a missing file")
+        ARE_EQUAL(11, p.Tag (), "wrong Tag(): missing")
+        IS_NULL(p.Next (), "Next(): a directory")
+        ARE_EQUAL(12, p.Tag (), "wrong Tag(): directory")
+        s = p.Next ();
+        IS_NOT_NULL(s, "Next(): an empty file")
+        ARE_EQUAL(13, p.Tag (), "wrong Tag(): empty")
+        IS_ZERO(s->Size (), "Size(): an empty file")
+        IS_ZERO(p.Count (), "Count(): all handed back")
+    }
+    unlink (f), unlink (e);
+}// test_the_prefetch()
+
+// "f" fails at an FFD_ENSURE() that says "m". It exits: a child process
+// runs it.
+template <typename F> static bool test_fails(F f, const char * m)
+{
+    int fd[2];
+    if (0 != pipe (fd)) return false;
+    fflush (stdout), fflush (stderr);
+    auto pid = fork ();
+    if (0 == pid) {
+        int null = open ("/dev/null", O_WRONLY);
+        dup2 (fd[1], 1), dup2 (null, 2), close (fd[0]), close (fd[1]);
+        f ();
+        fflush (stdout);
+        _exit (0);
+    }
+    close (fd[1]);
+    char out[1024] {};
+    int n {};
+    for (char b; 1 == read (fd[0], &b, 1);) if (n < 1023) out[n++] = b;
+    close (fd[0]);
+    int status {};
+    if (pid < 0 || pid != waitpid (pid, &status, 0)) return false;
+    return WIFEXITED(status) && 0 != WEXITSTATUS(status) && strstr (out, m);
+}
+
+void test_the_compile_path()
+{
+    TEST_NAME="FFD.CompilePath()";
+    // P: not of a fixed size - a node per item
+    const char d[] = "type byte 1" EOL EOL "struct P" EOL "    byte X" EOL
+        "    byte Y (X == 9)" EOL EOL "format F" EOL "    byte N" EOL
+        "    P Items[N]" EOL "    byte S" EOL;
+    FFD_NS::FFD ffd {reinterpret_cast<const byte *>(d), sizeof(d) - 1};
+    auto s = ffd.CompilePath ("S"), x = ffd.CompilePath ("Items[1].X");
+    ARE_EQUAL(1, s.Steps (), "S: wrong step count")
+    ARE_EQUAL(2, x.Steps (), "Items[1].X: wrong step count")
+    const byte data[] {2, 5, 6, 7};
+    FFD_NS::FFDMemoryStream m {data, sizeof(data)};
+    auto root = ffd.File2Tree (m);
+    IS_NOT_NULL(root, "no tree")
+    ARE_EQUAL(7, root->NodeByPath (s)->AsInt (), "wrong S")
+    ARE_EQUAL(6, root->NodeByPath (x)->AsInt (), "wrong Items[1].X")
+    IS_NULL(root->NodeByPath (ffd.CompilePath ("Items[2].X")),
+        "Items[2]: out of range, yet found")
+    FFD_NS::FFD::FreeNode (root);
+    struct { const char * Path, * Message; } const FAILS[] {
+        {"", "empty path"},
+        {"S..X", "empty path step"},
+        {"Nope", "no such field"},
+        {"X", "no such field at the struct"},
+        {"S.X", "a step past a scalar"},
+        {"Items.X", "index the arrays on it"},
+        {"S[0]", "\"[n]\" of no array of structs"},
+        {"Items[x].X", "\"name[n]\" it is"},
+        {"Items[1]x.X", "\"name[n]\" it is"}};
+    for (auto & f : FAILS)
+        IS_TRUE(test_fails ([&]{ ffd.CompilePath (f.Path); }, f.Message),
+            "CompilePath(): no such failure")
+}// test_the_compile_path()
+
+// Save() target: memory.
+class BenchSink final : public FFD_NS::Stream
+{
+    public: Stream & Write(const void * v, size_t b) override
+    {
+        int n = static_cast<int>(b);
+        if (Len + n > Buf.Length ()) Buf.Resize ((Len + n) * 2);
+        FFD_NS::OS::Memcpy (Buf.operator byte * () + Len, v, b);
+        return Len += n, *this;
+    }
+    public: Stream & Read(void *, size_t) override { return *this; }
+    public: off_t Tell() const override { return Len; }
+    public: off_t Size() const override { return Len; }
+    public: Stream & Seek(off_t) override { return *this; }
+    public: Stream & Reset() override { return Len = 0, *this; }
+    public: const byte * Data() const { return Buf.operator byte * (); }
+    public: FFD_NS::ByteArray Buf {};
+    public: int Len {};
+};
+
+// Save() after a File2Tree(): Load() of it parses the same.
+void test_the_image()
+{
+    TEST_NAME="FFD.Save()/Load()";
+    const char d[] = "type byte 1" EOL EOL "struct P" EOL "    byte X" EOL
+        "    byte Y (X == 9)" EOL EOL "format F" EOL "    byte N" EOL
+        "    P Items[N]" EOL;
+    auto text = reinterpret_cast<const byte *>(d);
+    FFD_NS::FFD ffd {text, sizeof(d) - 1};
+    const byte data[] {2, 9, 1, 5};
+    FFD_NS::FFDMemoryStream s1 {data, sizeof(data)};
+    auto a = ffd.File2Tree (s1);
+    IS_NOT_NULL(a, "no tree")
+    BenchSink image {};
+    ffd.Save (image);
+    IS_TRUE(image.Len > 0, "Save(): nothing")
+    auto loaded = FFD_NS::FFD::Load (image.Data (), image.Len, text,
+        sizeof(d) - 1);
+    IS_NOT_NULL(loaded, "Load() failed")
+    FFD_NS::FFDMemoryStream s2 {data, sizeof(data)};
+    auto b = loaded->File2Tree (s2);
+    IS_NOT_NULL(b, "Load(): no tree")
+    ARE_EQUAL(s1.Tell (), s2.Tell (), "Load(): not the same size")
+    for (auto t : {a, b}) {
+        auto items = t->NodeByName ("Items");
+        IS_NOT_NULL(items, "no Items")
+        ARE_EQUAL(2, items->Nodes ().Count (), "wrong Items count")
+        ARE_EQUAL(1, items->Nodes ()[0]->NodeByName ("Y")->AsInt (),
+            "wrong Items[0].Y")
+        IS_NULL(items->Nodes ()[1]->NodeByName ("Y"), "Items[1].Y")
+        ARE_EQUAL(5, items->Nodes ()[1]->NodeByName ("X")->AsInt (),
+            "wrong Items[1].X")
+    }
+    FFD_NS::FFD::FreeNode (a), FFD_NS::FFD::FreeNode (b);
+    FFD_NS::FFD::Free (loaded);
+    IS_NULL(FFD_NS::FFD::Load (image.Data (), image.Len, text,
+        sizeof(d) - 2), "Load(): stale image")
+}// test_the_image()
+
+// __ benchworks _______________________________________________________________
+// usage: test bench
+static double bench_ms()
+{
+    timespec t {};
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+// h * 31 + v, modulo 2^32 - in 64 bits: the sanitizers see no wrapping
+static inline unsigned int bench_mix(unsigned int h, int v)
+{
+    return static_cast<unsigned int>(
+        (h * 31ull + static_cast<unsigned int>(v)) & 0xffffffffu);
+}
+// printf() into a growing buffer
+struct BenchText final
+{
+    FFD_NS::ByteArray Buf {};
+    int Len {};
+    template <typename... A> void Add(const char * f, A... a)
+    {
+        int n = snprintf (nullptr, 0, f, a...);
+        if (Len + n + 1 > Buf.Length ()) Buf.Resize ((Len + n + 1) * 2);
+        snprintf (reinterpret_cast<char *>(Buf.operator byte * ()) + Len,
+            n + 1, f, a...);
+        Len += n;
+    }
+    const byte * Data() const { return Buf.operator byte * (); }
+};
+
+// 2 types, n/2 consts, n/2 structs: each field type is looked up by name.
+static void bench_description_load(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type int 4" EOL EOL);
+    for (int i = 0; i < n/2; i++) d.Add ("const C%d %d" EOL, i, i);
+    d.Add (EOL);
+    for (int i = 0; i < n/2 - 3; i++)
+        d.Add ("struct S%d" EOL "    int a" EOL "    byte b[C%d]" EOL
+            "    S%d c" EOL EOL, i, i, (i * 7919) % (n/2 - 3));
+    d.Add ("format F" EOL "    S0 s" EOL);
+    auto t = bench_ms ();
+    {
+        FFD_NS::FFD ffd {d.Data (), d.Len};
+    }
+    printf ("bench: FFD(%d symbols, %d bytes): %.3f ms" EOL, n, d.Len,
+        bench_ms () - t);
+    BenchSink image {};
+    {
+        FFD_NS::FFD ffd {d.Data (), d.Len};
+        ffd.Save (image);
+    }
+    t = bench_ms ();
+    auto ffd = FFD_NS::FFD::Load (image.Data (), image.Len, d.Data (), d.Len);
+    printf ("bench: FFD::Load(%d symbols, %d bytes): %.3f ms" EOL, n,
+        image.Len, bench_ms () - t);
+    FFD_ENSURE(nullptr != ffd, "bench: Load() failed")
+    FFD_NS::FFD::Free (ffd);
+}
+
+// Reads from memory; so it's the tree building that gets measured.
+class BenchStream final : public FFD_NS::Stream
+{
+    public: BenchStream(const byte * p, int len) : _p{p}, _len{len} {}
+    public: Stream & Read(void * v, size_t b) override
+    {
+        FFD_ENSURE(_pos + static_cast<off_t>(b) <= _len, "read past the end")
+        FFD_NS::OS::Memcpy (v, _p + _pos, b);
+        return Reads++, _pos += b, *this;
+    }
+    public: off_t Tell() const override { return _pos; }
+    public: off_t Size() const override { return _len; }
+    public: Stream & Seek(off_t o) override { return _pos += o, *this; }
+    public: Stream & Reset() override { return _pos = 0, *this; }
+    public: int Reads {};
+    private: const byte * _p;
+    private: off_t _len, _pos {};
+};
+
+static bool bench_same_tree(FFD_NS::FFDNode * a, FFD_NS::FFDNode * b)
+{
+    if (a->FieldNode ()->Name != b->FieldNode ()->Name) return false;
+    auto da = a->AsByteArray (), db = b->AsByteArray ();
+    if (da->Length () != db->Length ()) return false;
+    if (da->Length () > 0 && memcmp (da->operator byte * (),
+        db->operator byte * (), da->Length ())) return false;
+    if (a->Nodes ().Count () != b->Nodes ().Count ()) return false;
+    for (int i = 0; i < a->Nodes ().Count (); i++)
+        if (! bench_same_tree (a->Nodes ()[i], b->Nodes ()[i])) return false;
+    return true;
+}
+
+// File2Tree() "data", by the tree-walk and by FFD::Compile(); same trees.
+static void bench_file2tree(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    FFD_NS::FFD walk {d.Data (), d.Len}, compiled {d.Data (), d.Len};
+    compiled.Compile ();
+    double ms[2] {};
+    int reads[2] {};
+    FFD_NS::FFDNode * tree[2] {};
+    for (int r = 0; r < 5; r++)
+        for (int i = 0; i < 2; i++) {
+            FFD_NS::FFD & ffd = i ? compiled : walk;
+            BenchStream s {data, len};
+            auto t = bench_ms ();
+            auto root = ffd.File2Tree (s);
+            ms[i] += bench_ms () - t;
+            FFD_ENSURE(s.Tell () == len, "bench: not all data read")
+            reads[i] = s.Reads;
+            if (tree[i]) FFD_NS::FFD::FreeNode (tree[i]);
+            tree[i] = root;
+        }
+    FFD_ENSURE(bench_same_tree (tree[0], tree[1]), "bench: trees differ")
+    printf ("bench: File2Tree(%s, %d bytes): tree-walk: %.3f ms, "
+        "compiled: %.3f ms; Read() calls: %d, %d" EOL, what, len, ms[0] / 5,
+        ms[1] / 5, reads[0], reads[1]);
+    FFD_NS::FFD::FreeNode (tree[0]), FFD_NS::FFD::FreeNode (tree[1]);
+}
+
+// File2Tree() with nothing printed: the log disabled vs. filtered by level.
+// Below FFD_DBG_LEVEL the log calls are compiled out: compare the builds.
+static void bench_dbg(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    auto enabled = Dbg.Enabled;
+    auto level = Dbg.Level;
+    double ms[2] {};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 2; i++) {
+            Dbg.Enabled = 1 == i;
+            Dbg.Level = 1 == i ? FFD_DBG_INFO + 1 : level;
+            BenchStream s {data, len};
+            auto t = bench_ms ();
+            auto tree = ffd.File2Tree (s);
+            ms[i] += bench_ms () - t;
+            FFD_NS::FFD::FreeNode (tree);
+        }
+    Dbg.Enabled = enabled, Dbg.Level = level;
+    printf ("bench: File2Tree(%s), FFD_DBG_LEVEL %d: log disabled: %.3f ms, "
+        "filtered: %.3f ms" EOL, what, FFD_DBG_LEVEL, ms[0] / 3, ms[1] / 3);
+}
+
+// File2Tree() + FreeNode(): node by node vs. from an FFDArena; same trees.
+static void bench_arena(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    BenchStream s0 {data, len};
+    auto expected = ffd.File2Tree (s0);
+    FFD_NS::FFDArena arena {};
+    ParseContext ctx {ffd};
+    double ms[2] {};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 2; i++) {
+            ctx.Reset ();
+            ctx.Arena = i ? &arena : nullptr;
+            BenchStream s {data, len};
+            auto t = bench_ms ();
+            if (i) arena.Reset ();
+            auto tree = ffd.File2Tree (s, ctx);
+            FFD_ENSURE(i == tree->InArena (), "bench: arena: wrong allocator")
+            if (! r) FFD_ENSURE(bench_same_tree (expected, tree),
+                "bench: arena: trees differ")
+            FFD_NS::FFD::FreeNode (tree);
+            ms[i] += bench_ms () - t;
+        }
+    printf ("bench: File2Tree(%s) + free: heap: %.3f ms, arena: %.3f ms "
+        "(peak: %zu bytes)" EOL, what, ms[0] / 3, ms[1] / 3, arena.Peak ());
+    FFD_NS::FFD::FreeNode (expected);
+}
+
+// The same nodes, data and hash key values as the tree "a".
+static bool bench_same_table(FFD_NS::FFDNode * a, FFD_NS::FFDTable::Node b)
+{
+    if (a->FieldNode () != b.FieldNode ()) return false;
+    auto data = a->AsByteArray ();
+    if (data->Length () != b.Length ()
+        || (data->Length () > 0 && memcmp (data->operator byte * (),
+            b.Data (), b.Length ()))) return false;
+    if (a->Nodes ().Count () != b.Nodes ().Count ()) return false;
+    if (a->ArrayOfFields () != b.ArrayOfFields ()) return false;
+    for (int i = 0; i < a->Nodes ().Count (); i++)
+        if (! bench_same_table (a->Nodes ()[i], b.Nodes ()[i])) return false;
+    return true;
+}
+
+// Sums "Len" of the records, by NodeByName() and AsInt(), and the data
+// lengths of all nodes.
+static long bench_visit(FFD_NS::FFDNode * n)
+{
+    long r = n->AsByteArray ()->Length ();
+    auto len = n->NodeByName ("Len");
+    if (len) r += len->AsInt ();
+    for (auto f : n->Nodes ()) r += bench_visit (f);
+    return r;
+}
+static long bench_visit(FFD_NS::FFDTable::Node n)
+{
+    long r = n.Length ();
+    auto len = n.NodeByName ("Len");
+    if (len) r += len.AsInt ();
+    for (auto f : n.Nodes ()) r += bench_visit (f);
+    return r;
+}
+
+// File2Tree() to an FFDArena, then flattened to an FFDTable: bytes per node
+// and a full visit of each.
+static void bench_table(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    FFD_NS::FFDArena arena {};
+    ParseContext ctx {ffd};
+    ctx.Arena = &arena;
+    BenchStream s {data, len};
+    auto tree = ffd.File2Tree (s, ctx);
+    auto nodes = 1 + tree->TotalNodeCount ();
+    auto t = bench_ms ();
+    FFD_NS::FFDTable table {tree};
+    auto flat_ms = bench_ms () - t;
+    FFD_ENSURE(table.Count () == nodes, "bench: table: node count")
+    FFD_ENSURE(bench_same_table (tree, table.Root ()),
+        "bench: table: nodes differ")
+    double ms[2] {};
+    long sum[2] {};
+    for (int r = 0; r < 3; r++) {
+        t = bench_ms ();
+        sum[0] = bench_visit (tree);
+        ms[0] += bench_ms () - t;
+        t = bench_ms ();
+        sum[1] = bench_visit (table.Root ());
+        ms[1] += bench_ms () - t;
+    }
+    FFD_ENSURE(sum[0] == sum[1], "bench: table: visits differ")
+    printf ("bench: FFDTable(%s, %d nodes): arena tree: %zu bytes (%.1f/node), "
+        "table: %zu bytes (%.1f/node), flatten: %.3f ms; visit: tree: %.3f ms,"
+        " table: %.3f ms" EOL, what, nodes, arena.Used (),
+        static_cast<double>(arena.Used ()) / nodes, table.Size (),
+        static_cast<double>(table.Size ()) / nodes, flat_ms, ms[0] / 3,
+        ms[1] / 3);
+    arena.Reset ();
+}
+
+// File2Tree() of an in-memory buffer: by BenchStream - a virtual Read() per
+// field - and by FFDMemoryStream - read inline; same trees.
+static void bench_memory(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    double ms[2] {};
+    FFD_NS::FFDNode * tree[2] {};
+    for (int r = 0; r < 5; r++)
+        for (int i = 0; i < 2; i++) {
+            BenchStream bs {data, len};
+            FFD_NS::FFDMemoryStream mem {data, static_cast<size_t>(len)};
+            FFD_NS::Stream & s = i ? static_cast<FFD_NS::Stream &>(mem) : bs;
+            auto t = bench_ms ();
+            auto root = ffd.File2Tree (s);
+            ms[i] += bench_ms () - t;
+            FFD_ENSURE(s.Tell () == len, "bench: not all data read")
+            if (tree[i]) FFD_NS::FFD::FreeNode (tree[i]);
+            tree[i] = root;
+        }
+    FFD_ENSURE(bench_same_tree (tree[0], tree[1]), "bench: memory: trees "
+        "differ")
+    printf ("bench: File2Tree(%s), compiled: BenchStream: %.3f ms, "
+        "FFDMemoryStream: %.3f ms" EOL, what, ms[0] / 5, ms[1] / 5);
+    FFD_NS::FFD::FreeNode (tree[0]), FFD_NS::FFD::FreeNode (tree[1]);
+}
+
+// [bytes] the node data owned by the tree - not views into a mapping.
+static long bench_copied(FFD_NS::FFDNode * n)
+{
+    auto data = n->AsByteArray ();
+    long r = data->IsView () ? 0 : data->Length ();
+    for (auto f : n->Nodes ()) r += bench_copied (f);
+    return r;
+}
+
+// File2Tree() of a file: read by TestStream, FFDMapStream copies, and
+// FFDMapStream views; same trees.
+static void bench_map(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    char fn[] {"/tmp/ffd_bench_XXXXXX"};
+    int fd = mkstemp (fn);
+    FFD_ENSURE(fd >= 0, "bench: mkstemp() failed")
+    FFD_ENSURE(write (fd, data, len) == len, "bench: write() failed")
+    close (fd);
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    BenchStream s0 {data, len};
+    auto expected = ffd.File2Tree (s0);
+    static char const * const MODE[3] {"TestStream", "mapped", "views"};
+    double ms[3] {};
+    long copied[3] {};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 3; i++) {
+            ParseContext ctx {ffd};
+            auto t = bench_ms ();
+            FFD_NS::FFDNode * tree {};
+            if (! i) {
+                FFD_NS::TestStream s {fn};
+                FFD_ENSURE(s, "bench: can't open the file")
+                tree = ffd.File2Tree (s, ctx);
+                FFD_ENSURE(s.Tell () == len, "bench: not all data read")
+            }
+            else {
+                FFD_NS::FFDMapStream s {fn};
+                FFD_ENSURE(s, "bench: can't map the file")
+                if (2 == i) ctx.Map = &s;
+                tree = ffd.File2Tree (s, ctx);
+                FFD_ENSURE(s.Tell () == len, "bench: not all data read")
+                if (! r) {
+                    FFD_ENSURE(bench_same_tree (expected, tree),
+                        "bench: map: trees differ")
+                    copied[i] = bench_copied (tree);
+                }
+            }
+            ms[i] += bench_ms () - t;
+            if (! r && ! i) copied[i] = bench_copied (tree);
+            FFD_NS::FFD::FreeNode (tree);
+        }
+    unlink (fn);
+    for (int i = 0; i < 3; i++)
+        printf ("bench: File2Tree(%s) file, %s: %.3f ms, %ld bytes copied"
+            EOL, what, MODE[i], ms[i] / 3, copied[i]);
+    FFD_NS::FFD::FreeNode (expected);
+}
+
+// Counts the events; the same counts are made out of a tree.
+class BenchVisitor final : public FFD_NS::FFDVisitor
+{
+    public: void OnStructBegin(FFD_NS::FFD::SNode *) override
+    {
+        Nodes++, Depth++;
+    }
+    public: void OnStructEnd(FFD_NS::FFD::SNode *) override { Depth--; }
+    public: void OnField(FFD_NS::FFD::SNode *, const byte * data, int len)
+        override
+    {
+        Nodes++, Bytes += len;
+        for (int i = 0; i < len; i++) Sum += data[i];
+    }
+    public: void OnArray(FFD_NS::FFD::SNode *, int, const byte * data,
+        int len) override
+    {
+        OnField (nullptr, data, len);
+    }
+    public: long Nodes {}, Bytes {}, Sum {};
+    public: int Depth {};
+};
+static void bench_count(FFD_NS::FFDNode * n, BenchVisitor & v)
+{
+    auto data = n->AsByteArray ();
+    v.Nodes++, v.Bytes += data->Length ();
+    for (int i = 0; i < data->Length (); i++) v.Sum += (*data)[i];
+    for (auto f : n->Nodes ()) bench_count (f, v);
+}
+
+// File2Tree() + FreeNode() vs. an FFDVisitor with an FFDProjection of no
+// paths: the same fields, no tree.
+static void bench_visitor(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    FFD_NS::FFDProjection deps {ffd, FFD_NS::List<FFD_NS::String> {}};
+    ParseContext ctx {ffd};
+    BenchVisitor expected {}, v {};
+    double ms[2] {};
+    int kept {};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 2; i++) {
+            ctx.Reset ();
+            ctx.Projection = i ? &deps : nullptr;
+            ctx.Visitor = i ? &v : nullptr;
+            v = BenchVisitor {};
+            FFD_NS::FFDMemoryStream s {data, static_cast<size_t>(len)};
+            auto t = bench_ms ();
+            auto tree = ffd.File2Tree (s, ctx);
+            if (! i && ! r) bench_count (tree, expected);
+            if (i) kept = tree->TotalNodeCount ();
+            FFD_NS::FFD::FreeNode (tree);
+            ms[i] += bench_ms () - t;
+            FFD_ENSURE(s.Tell () == len, "bench: not all data read")
+        }
+    FFD_ENSURE(expected.Nodes == v.Nodes && expected.Bytes == v.Bytes
+        && expected.Sum == v.Sum && 0 == v.Depth,
+        "bench: visitor: not the same fields")
+    printf ("bench: File2Tree(%s) + free: %.3f ms; FFDVisitor: %.3f ms, "
+        "%ld events, %d nodes kept" EOL, what, ms[0] / 3, ms[1] / 3, v.Nodes,
+        kept);
+}
+
+// FFD::Save() then FFD::Load(): same tree as the text-parsed description;
+// stale or damaged images are refused.
+static void bench_image(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    auto t = bench_ms ();
+    FFD_NS::FFD text {d.Data (), d.Len};
+    auto parse_ms = bench_ms () - t;
+    BenchSink image {};
+    t = bench_ms ();
+    text.Save (image);
+    auto save_ms = bench_ms () - t;
+    t = bench_ms ();
+    auto loaded = FFD_NS::FFD::Load (image.Data (), image.Len, d.Data (),
+        d.Len);
+    auto load_ms = bench_ms () - t;
+    FFD_ENSURE(nullptr != loaded, "bench: Load() failed")
+    printf ("bench: description(%s): text: %.3f ms, Save: %.3f ms, "
+        "Load(%d bytes): %.3f ms" EOL, what, parse_ms, save_ms, image.Len,
+        load_ms);
+    BenchStream s1 {data, len}, s2 {data, len};
+    auto a = text.File2Tree (s1), b = loaded->File2Tree (s2);
+    FFD_ENSURE(bench_same_tree (a, b), "bench: loaded image: trees differ")
+    FFD_NS::FFD::FreeNode (a), FFD_NS::FFD::FreeNode (b);
+    FFD_NS::FFD::Free (loaded);
+
+    FFD_NS::ByteArray other {};
+    other.Resize (d.Len);
+    FFD_NS::OS::Memcpy (other.operator byte * (), d.Data (), d.Len);
+    other[d.Len - 2] ^= 1;
+    FFD_ENSURE(nullptr == FFD_NS::FFD::Load (image.Data (), image.Len,
+        other.operator byte * (), d.Len), "bench: stale image loaded")
+    image.Buf[image.Len / 2] ^= 1;
+    FFD_ENSURE(nullptr == FFD_NS::FFD::Load (image.Data (), image.Len,
+        d.Data (), d.Len), "bench: damaged image loaded")
+    FFD_ENSURE(nullptr == FFD_NS::FFD::Load (image.Data (), image.Len / 2,
+        d.Data (), d.Len), "bench: truncated image loaded")
+}
+
+// One FFD, a ParseContext per thread: the trees must be the same as the one
+// parsed by a single thread.
+struct BenchShared final
+{
+    const FFD_NS::FFD * Ffd;
+    const byte * Data;
+    int Len;
+    FFD_NS::FFDNode * Expected;
+    int Runs;
+    bool Ok;
+};
+static void * bench_shared_thread(void * p)
+{
+    auto & b = *static_cast<BenchShared *>(p);
+    ParseContext ctx {*(b.Ffd)};
+    b.Ok = true;
+    for (int i = 0; i < b.Runs; i++) {
+        ctx.Reset ();
+        BenchStream s {b.Data, b.Len};
+        auto tree = b.Ffd->File2Tree (s, ctx);
+        b.Ok = b.Ok && s.Tell () == b.Len
+            && bench_same_tree (b.Expected, tree);
+        FFD_NS::FFD::FreeNode (tree);
+    }
+    return nullptr;
+}
+static void bench_shared(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    const int THREADS {4}, RUNS {3};
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    BenchStream s {data, len};
+    auto expected = ffd.File2Tree (s);
+    double ms[2] {};
+    for (int n = 1, r = 0; r < 2; n = THREADS, r++) {
+        BenchShared b[THREADS] {};
+        pthread_t t[THREADS] {};
+        auto start = bench_ms ();
+        for (int i = 0; i < n; i++) {
+            b[i] = BenchShared {&ffd, data, len, expected, THREADS * RUNS / n,
+                false};
+            FFD_ENSURE(0 == pthread_create (t + i, nullptr,
+                bench_shared_thread, b + i), "bench: pthread_create() failed")
+        }
+        for (int i = 0; i < n; i++) pthread_join (t[i], nullptr);
+        ms[r] = bench_ms () - start;
+        for (int i = 0; i < n; i++)
+            FFD_ENSURE(b[i].Ok, "bench: shared FFD: trees differ")
+    }
+    printf ("bench: File2Tree(%s) x %d, one FFD: 1 thread: %.3f ms, "
+        "%d threads: %.3f ms" EOL, what, THREADS * RUNS, ms[0], THREADS,
+        ms[1]);
+    FFD_NS::FFD::FreeNode (expected);
+}
+
+// FFDCorpus: JOBS in-memory files, 1 worker vs. one per CPU; ordered and
+// not. Same trees; the ordered ones reported in Add() order.
+class BenchCorpusClient final : public FFD_NS::FFDCorpus::Client
+{
+    public: BenchCorpusClient(int workers, const byte * data, int len,
+        FFD_NS::FFDNode * expected)
+        : _expected {expected}
+    {
+        for (int i = 0; i < workers; i++) _s.Add (BenchStream {data, len});
+    }
+    public: FFD_NS::Stream * Open(int worker, const char *) override
+    {
+        return &(_s[worker].Reset ());
+    }
+    public: void Parsed(const FFD_NS::FFDCorpus::Result & r) override
+    {
+        bool ok = r.Unread == 0 && bench_same_tree (_expected, r.Tree);
+        __atomic_fetch_add (ok ? &Ok : &Failed, 1, __ATOMIC_RELAXED);
+        if (Ordered && r.Index != Next++) Failed++;
+    }
+    public: int Ok {}, Failed {}, Next {};
+    public: bool Ordered {};
+    private: FFD_NS::FFDNode * _expected;
+    private: FFD_NS::List<BenchStream> _s {};
+};
+static void bench_corpus(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    const int JOBS {16};
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    BenchStream s {data, len};
+    auto expected = ffd.File2Tree (s);
+    FFD_NS::FFDCorpus one {ffd, 1}, all {ffd};
+    for (int i = 0; i < JOBS; i++) one.Add ("mem"), all.Add ("mem");
+    double ms[2][2] {};
+    for (int c = 0; c < 2; c++)
+        for (int o = 0; o < 2; o++) {
+            auto & corpus = c ? all : one;
+            BenchCorpusClient client {corpus.Workers (), data, len, expected};
+            client.Ordered = o;
+            auto t = bench_ms ();
+            corpus.Run (client, client.Ordered);
+            ms[c][o] = bench_ms () - t;
+            FFD_ENSURE(JOBS == client.Ok && ! client.Failed,
+                "bench: FFDCorpus: trees differ")
+        }
+    printf ("bench: FFDCorpus(%s) x %d: 1 worker: %.3f ms (ordered: %.3f ms)"
+        ", %d workers: %.3f ms (ordered: %.3f ms); arena peak: %zu bytes" EOL,
+        what, JOBS, ms[0][0], ms[0][1], all.Workers (), ms[1][0], ms[1][1],
+        all.ArenaPeak ());
+    FFD_NS::FFD::FreeNode (expected);
+}
+
+// Files: one TestStream per worker; or FFDCorpus::Prefetch() - Opened().
+class BenchFileClient final : public FFD_NS::FFDCorpus::Client
+{
+    using FILE_STREAM = FFD_NS::TestStream;
+    public: BenchFileClient(int workers, FFD_NS::FFDNode * expected)
+        : _expected {expected}
+    {
+        for (int i = 0; i < workers; i++) _s.Add (nullptr);
+    }
+    public: ~BenchFileClient() override
+    {
+        for (auto s : _s) FFD_DESTROY_OBJECT(s, FILE_STREAM)
+    }
+    public: FFD_NS::Stream * Open(int worker, const char * n) override
+    {
+        FFD_DESTROY_OBJECT(_s[worker], FILE_STREAM)
+        FFD_CREATE_OBJECT(_s[worker], FILE_STREAM) {n};
+        return *(_s[worker]) ? _s[worker] : nullptr;
+    }
+    public: void Parsed(const FFD_NS::FFDCorpus::Result & r) override
+    {
+        bool ok = r.Unread == 0 && bench_same_tree (_expected, r.Tree);
+        __atomic_fetch_add (ok ? &Ok : &Failed, 1, __ATOMIC_RELAXED);
+    }
+    public: int Ok {}, Failed {};
+    private: FFD_NS::FFDNode * _expected;
+    private: FFD_NS::List<FILE_STREAM *> _s {};
+};
+// A corpus of files on disk, out of the page cache before each run: read by
+// the parsing thread vs. read ahead by FFDPrefetch.
+static void bench_prefetch(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    const int JOBS {16};
+    char dir[] {"/tmp/ffd_bench_XXXXXX"};
+    FFD_ENSURE(mkdtemp (dir), "bench: mkdtemp() failed")
+    FFD_NS::List<FFD_NS::String> files {};
+    for (int i = 0; i < JOBS; i++) {
+        char fn[64] {};
+        snprintf (fn, sizeof(fn), "%s/%02d.bin", dir, i);
+        int fd = open (fn, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        FFD_ENSURE(fd >= 0, "bench: open() failed")
+        FFD_ENSURE(write (fd, data, len) == len, "bench: write() failed")
+        FFD_ENSURE(0 == fsync (fd), "bench: fsync() failed")
+        close (fd);
+        files.Add (FFD_NS::String {fn});
+    }
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    BenchStream s {data, len};
+    auto expected = ffd.File2Tree (s);
+    FFD_NS::FFDCorpus corpus {ffd};
+    for (auto & f : files) corpus.Add (f.AsZStr ());
+    static char const * const MODE[3] {"TestStream", "threads", "io_uring"};
+    double ms[3] {};
+    for (int m = 0; m < 3; m++) {
+        for (auto & f : files) { // cold
+            int fd = open (f.AsZStr (), O_RDONLY);
+            FFD_ENSURE(fd >= 0, "bench: open() failed")
+            posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+            close (fd);
+        }
+        corpus.Prefetch (m ? 8 : 0, 2 == m);
+        BenchFileClient client {corpus.Workers (), expected};
+        auto t = bench_ms ();
+        corpus.Run (client);
+        ms[m] = bench_ms () - t;
+        FFD_ENSURE(JOBS == client.Ok && ! client.Failed,
+            "bench: prefetch: trees differ")
+    }
+    for (auto & f : files) unlink (f.AsZStr ());
+    rmdir (dir);
+    printf ("bench: FFDCorpus(%s) x %d files, %d workers, cold cache: %s: "
+        "%.3f ms; Prefetch(8): %s: %.3f ms, %s: %.3f ms" EOL, what, JOBS,
+        corpus.Workers (), MODE[0], ms[0], MODE[1], ms[1], MODE[2], ms[2]);
+    FFD_NS::FFD::FreeNode (expected);
+}
+
+// gzip-ed: inflated whole, then parsed vs. FFDInflateStream - inflated by a
+// thread while it is parsed.
+static void bench_inflate(const char * what, const BenchText & d,
+    const byte * data, int len)
+{
+    z_stream zs {};
+    FFD_ENSURE(Z_OK == deflateInit2 (&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+        31, 8, Z_DEFAULT_STRATEGY), "bench: deflateInit2() failed")
+    FFD_NS::ByteArray gz {};
+    gz.Resize (static_cast<int>(deflateBound (&zs, len)));
+    zs.next_in = const_cast<Bytef *>(data), zs.avail_in = len;
+    zs.next_out = gz.operator byte * (), zs.avail_out = gz.Length ();
+    FFD_ENSURE(Z_STREAM_END == deflate (&zs, Z_FINISH),
+        "bench: deflate() failed")
+    int size = static_cast<int>(zs.total_out);
+    deflateEnd (&zs);
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    BenchStream s0 {data, len};
+    auto expected = ffd.File2Tree (s0);
+    double ms[2] {}, inflate_ms {};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 2; i++) {
+            FFD_NS::FFDArena arena {};
+            ParseContext ctx {ffd};
+            ctx.Arena = &arena;
+            FFD_NS::FFDMemoryStream gs {gz.operator byte * (),
+                static_cast<size_t>(size)};
+            auto t = bench_ms ();
+            int usize {};
+            gs.Seek (size - 4).Read (&usize, 4).Reset (); // ISIZE
+            FFD_ENSURE(usize == len, "bench: inflate: wrong ISIZE")
+            FFD_NS::FFDNode * tree {};
+            if (! i) {
+                FFD_NS::ByteArray buf {};
+                buf.Resize (usize);
+                z_stream is {};
+                FFD_ENSURE(Z_OK == inflateInit2 (&is, 31),
+                    "bench: inflateInit2() failed")
+                is.next_in = gz.operator byte * (), is.avail_in = size;
+                is.next_out = buf.operator byte * (), is.avail_out = usize;
+                FFD_ENSURE(Z_STREAM_END == inflate (&is, Z_FINISH),
+                    "bench: inflate() failed")
+                inflateEnd (&is);
+                inflate_ms += bench_ms () - t;
+                FFD_NS::FFDMemoryStream s {buf.operator byte * (),
+                    static_cast<size_t>(usize)};
+                tree = ffd.File2Tree (s, ctx);
+                ms[i] += bench_ms () - t;
+            }
+            else {
+                FFD_NS::FFDInflateStream s {&gs, size, usize, true};
+                tree = ffd.File2Tree (s, ctx);
+                ms[i] += bench_ms () - t;
+                FFD_ENSURE(s.Tell () == len, "bench: not all data read")
+            }
+            if (! r)
+                FFD_ENSURE(bench_same_tree (expected, tree),
+                    "bench: inflate: trees differ")
+        }
+    // ISIZE short: the buffer grows; long: Size() is what there is
+    for (int usize : {len / 3 + 1, 2 * len}) {
+        FFD_NS::FFDMemoryStream gs {gz.operator byte * (),
+            static_cast<size_t>(size)};
+        FFD_NS::FFDInflateStream s {&gs, size, usize, true};
+        auto tree = ffd.File2Tree (s);
+        FFD_ENSURE(bench_same_tree (expected, tree) && s.Tell () == len
+            && s.Inflated () == len, "bench: inflate: a wrong ISIZE is trusted")
+        FFD_NS::FFD::FreeNode (tree);
+    }
+    printf ("bench: File2Tree(%s), gzip %d of %d bytes: inflate, then parse:"
+        " %.3f ms (inflate: %.3f ms); FFDInflateStream: %.3f ms" EOL, what,
+        size, len, ms[0] / 3, inflate_ms / 3, ms[1] / 3);
+    FFD_NS::FFD::FreeNode (expected);
+}
+
+// Appends "size" bytes of "v".
+struct BenchData final
+{
+    FFD_NS::ByteArray Buf {};
+    int Len {};
+    bool Big {}; // Add(): big-endian
+    void Add(int v, int size)
+    {
+        if (Len + size > Buf.Length ()) Buf.Resize ((Len + size) * 2);
+        auto p = Buf.operator byte * () + Len;
+        FFD_NS::OS::Memcpy (p, &v, size);
+        for (int i = 0; Big && i < size / 2; i++) {
+            auto t = p[i];
+            p[i] = p[size - 1 - i], p[size - 1 - i] = t;
+        }
+        Len += size;
+    }
+    const byte * Data() const { return Buf.operator byte * (); }
+};
+
+// n records: scalars, a conditional field, a const-sized and a dynamic array.
+static void bench_decode(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "const N 16" EOL EOL
+        "enum Kind byte" EOL "    KA 1" EOL "    KB 2" EOL EOL
+        "struct Hdr" EOL "    int Version" EOL "    byte Flags" EOL EOL
+        "struct Rec" EOL "    Kind K" EOL "    short Len" EOL
+        "    int Extra (K == KB)" EOL "    byte Pad[N]" EOL
+        "    byte Name[Len]" EOL EOL
+        "format F" EOL "    Hdr H" EOL "    int Count" EOL
+        "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (7, 4), data.Add (0, 1), data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        int k = 1 + (i & 1), name_len = 3 + i % 13;
+        data.Add (k, 1), data.Add (name_len, 2);
+        if (2 == k) data.Add (i, 4);
+        for (int j = 0; j < 16; j++) data.Add (j, 1);
+        for (int j = 0; j < name_len; j++) data.Add ('a' + j, 1);
+    }
+    char what[64];
+    snprintf (what, sizeof(what), "%d records", n);
+    bench_file2tree (what, d, data.Data (), data.Len);
+    bench_dbg (what, d, data.Data (), data.Len);
+    bench_arena (what, d, data.Data (), data.Len);
+    bench_table (what, d, data.Data (), data.Len);
+    bench_map (what, d, data.Data (), data.Len);
+    bench_memory (what, d, data.Data (), data.Len);
+    bench_visitor (what, d, data.Data (), data.Len);
+    bench_image ("records", d, data.Data (), data.Len);
+    bench_shared (what, d, data.Data (), data.Len);
+    bench_corpus (what, d, data.Data (), data.Len);
+    bench_prefetch (what, d, data.Data (), data.Len);
+    bench_inflate (what, d, data.Data (), data.Len);
+}
+
+// n records of mostly conditional fields: enum items, consts, "a.b" paths,
+// nested and negated expressions.
+static void bench_conditions(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type int 4" EOL EOL "const LIM 3" EOL EOL
+        "enum Kind byte" EOL "    KA 1" EOL "    KB 2" EOL "    KC 3" EOL EOL
+        "struct Pos" EOL "    byte X" EOL "    byte Y" EOL EOL
+        "struct Rec" EOL "    Kind K" EOL "    byte V" EOL "    Pos P" EOL
+        "    byte A (K == KB)" EOL "    byte B ((K == KA) || (K == KC))" EOL
+        "    byte C (!(V > 5))" EOL "    byte D (V > LIM)" EOL
+        "    int E (P.X == 1)" EOL "    byte F (V & 4)" EOL
+        "    byte G (K != KC)" EOL "    byte H ((V > 1) && (V < 9))" EOL EOL
+        "format F" EOL "    int Count" EOL "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        int k = 1 + i % 3, v = i % 11, x = i % 3;
+        data.Add (k, 1), data.Add (v, 1), data.Add (x, 1), data.Add (i, 1);
+        if (2 == k) data.Add (i, 1);
+        if (2 != k) data.Add (i, 1);
+        if (v <= 5) data.Add (i, 1);
+        if (v > 3) data.Add (i, 1);
+        if (1 == x) data.Add (i, 4);
+        if (v & 4) data.Add (i, 1);
+        if (3 != k) data.Add (i, 1);
+        if (v > 1 && v < 9) data.Add (i, 1);
+    }
+    char what[64];
+    snprintf (what, sizeof(what), "%d conditional records", n);
+    bench_file2tree (what, d, data.Data (), data.Len);
+    bench_visitor (what, d, data.Data (), data.Len);
+    bench_image ("conditional records", d, data.Data (), data.Len);
+    bench_shared (what, d, data.Data (), data.Len);
+}
+
+// n objects of fixed-layout parts; File2Tree() then a header field, the last
+// field and one object: eager vs. FFD::ParseContext::Lazy; same trees.
+static void bench_lazy(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "struct Hdr" EOL "    int Version" EOL "    byte Flags" EOL EOL
+        "struct Vec" EOL "    int X" EOL "    int Y" EOL "    int Z" EOL EOL
+        "struct Obj" EOL "    Vec P" EOL "    Vec N" EOL "    short Id" EOL
+        "    byte Pad[8]" EOL EOL
+        "format F" EOL "    Hdr H" EOL "    int Count" EOL
+        "    Obj Objs[Count]" EOL "    int Tail" EOL);
+    BenchData data {};
+    data.Add (7, 4), data.Add (0, 1), data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < 6; j++) data.Add (i + j, 4);
+        data.Add (i, 2);
+        for (int j = 0; j < 8; j++) data.Add (j, 1);
+    }
+    data.Add (42, 4);
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    double ms[2] {};
+    size_t used[2] {};
+    int v[2][3] {};
+    FFD_NS::FFDArena arena[2] {};
+    FFD_NS::FFDNode * tree[2] {};
+    FFD_NS::FFDMemoryStream s0 {data.Data (), static_cast<size_t>(data.Len)},
+        s1 {data.Data (), static_cast<size_t>(data.Len)};
+    ParseContext ctx0 {ffd}, ctx1 {ffd};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 2; i++) {
+            auto & ctx = i ? ctx1 : ctx0;
+            FFD_NS::Stream & s = i ? s1 : s0;
+            arena[i].Reset (), ctx.Reset (), s.Reset ();
+            ctx.Arena = &arena[i], ctx.Lazy = 1 == i;
+            auto t = bench_ms ();
+            auto root = ffd.File2Tree (s, ctx);
+            v[i][0] = root->NodeByName ("H")->Get<int> ("Version");
+            v[i][1] = root->Get<int> ("Tail");
+            v[i][2] = (*root->NodeByName ("Objs"))[n / 2]->NodeByName ("P")
+                ->Get<int> ("Y");
+            ms[i] += bench_ms () - t;
+            used[i] = arena[i].Used ();
+            tree[i] = root;
+        }
+    for (int j = 0; j < 3; j++)
+        FFD_ENSURE(v[0][j] == v[1][j], "bench: lazy: values differ")
+    FFD_ENSURE(7 == v[1][0] && 42 == v[1][1] && n / 2 + 1 == v[1][2],
+        "bench: lazy: wrong values")
+    FFD_ENSURE(bench_same_tree (tree[0], tree[1]), "bench: lazy: trees differ")
+    printf ("bench: File2Tree(%d objects, %d bytes) + 3 lookups: eager: %.3f "
+        "ms, %zu bytes; lazy: %.3f ms, %zu bytes (%zu bytes when all read)"
+        EOL, n, data.Len, ms[0] / 3, used[0], ms[1] / 3, used[1],
+        arena[1].Used ());
+}
+
+// n records; File2Tree() of 2 paths of them vs. the whole tree, by the
+// tree-walk and by FFD::Compile(); the same values.
+static void bench_projection(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "const N 16" EOL EOL
+        "enum Kind byte" EOL "    KA 1" EOL "    KB 2" EOL EOL
+        "struct Hdr" EOL "    int Version" EOL "    byte Flags" EOL EOL
+        "struct Vec" EOL "    int X" EOL "    int Y" EOL "    int Z" EOL EOL
+        "struct Rec" EOL "    Kind K" EOL "    short Len" EOL
+        "    int Extra (K == KB)" EOL "    Vec P" EOL "    byte Pad[N]" EOL
+        "    byte Name[Len]" EOL "    int Score" EOL EOL
+        "format F" EOL "    Hdr H" EOL "    int Count" EOL
+        "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (7, 4), data.Add (0, 1), data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        int k = 1 + (i & 1), name_len = 3 + i % 13;
+        data.Add (k, 1), data.Add (name_len, 2);
+        if (2 == k) data.Add (i, 4);
+        for (int j = 0; j < 3; j++) data.Add (i + j, 4);
+        for (int j = 0; j < 16; j++) data.Add (j, 1);
+        for (int j = 0; j < name_len; j++) data.Add ('a' + (i + j) % 26, 1);
+        data.Add (i, 4);
+    }
+    FFD_NS::List<FFD_NS::String> paths {};
+    paths.Add ("H.Version"), paths.Add ("Items[*].Name");
+    FFD_NS::FFD walk {d.Data (), d.Len}, compiled {d.Data (), d.Len};
+    compiled.Compile ();
+    double ms[2][2] {};
+    size_t used[2][2] {};
+    int nodes[2][2] {};
+    unsigned int sum[2][2] {};
+    for (int i = 0; i < 2; i++) {
+        FFD_NS::FFD & ffd = i ? compiled : walk;
+        FFD_NS::FFDProjection projection {ffd, paths};
+        FFD_NS::FFDArena arena {};
+        ParseContext ctx {ffd};
+        ctx.Arena = &arena;
+        for (int r = 0; r < 3; r++)
+            for (int j = 0; j < 2; j++) {
+                arena.Reset (), ctx.Reset ();
+                ctx.Projection = j ? &projection : nullptr;
+                FFD_NS::FFDMemoryStream s {data.Data (),
+                    static_cast<size_t>(data.Len)};
+                auto t = bench_ms ();
+                auto root = ffd.File2Tree (s, ctx);
+                ms[i][j] += bench_ms () - t;
+                FFD_ENSURE(s.Tell () == data.Len, "bench: not all data read")
+                unsigned int h = root->NodeByName ("H")->Get<int> ("Version");
+                auto items = root->NodeByName ("Items");
+                FFD_ENSURE(n == items->NodeCount (), "bench: wrong count")
+                for (auto item : items->Nodes ()) {
+                    auto name = item->NodeByName ("Name")->AsByteArray ();
+                    for (int b = 0; b < name->Length (); b++)
+                        h = bench_mix (h, (*name)[b]);
+                    if (j) FFD_ENSURE(nullptr == item->NodeByName ("P")
+                        && nullptr == item->NodeByName ("Score"),
+                        "bench: projection: not skipped")
+                }
+                sum[i][j] = h, used[i][j] = arena.Used ();
+                nodes[i][j] = root->TotalNodeCount ();
+            }
+        FFD_ENSURE(sum[i][0] == sum[i][1], "bench: projection: values differ")
+        printf ("bench: File2Tree(%d records, %d bytes), %s: whole: %.3f ms, "
+            "%d nodes, %zu bytes; 2 paths: %.3f ms, %d nodes, %zu bytes" EOL,
+            n, data.Len, i ? "compiled" : "tree-walk", ms[i][0] / 3,
+            nodes[i][0], used[i][0], ms[i][1] / 3, nodes[i][1], used[i][1]);
+    }
+}
+
+// A stream that is not an FFDMemoryStream: Read() copies; Peek() and
+// Borrow() when "lend".
+class BenchReader final : public FFD_NS::Stream
+{
+    public: BenchReader(const byte * p, int len, bool lend = false)
+        : _p {p}, _len {len}, _lend {lend} {}
+    public: Stream & Read(void * v, size_t b) override
+    {
+        int n = static_cast<int>(b);
+        FFD_ENSURE(n <= _len - _pos, "bench: read past the end")
+        FFD_NS::OS::Memcpy (v, _p + _pos, b);
+        return Copied += n, _pos += n, *this;
+    }
+    public: const byte * Peek(size_t b) override
+    {
+        if (! _lend || static_cast<int>(b) > _len - _pos) return nullptr;
+        return _p + _pos;
+    }
+    public: const byte * Borrow(size_t b) override
+    {
+        auto result = Peek (b);
+        if (result) _pos += static_cast<int>(b);
+        return result;
+    }
+    public: off_t Tell() const override { return _pos; }
+    public: off_t Size() const override { return _len; }
+    public: Stream & Seek(off_t ofs) override
+    {
+        return _pos += static_cast<int>(ofs), *this;
+    }
+    public: Stream & Reset() override { return _pos = 0, *this; }
+    public: long Copied {}; // by Read() [bytes]
+    private: const byte * _p;
+    private: int _len, _pos {};
+    private: bool _lend;
+};
+
+// 2 arrays of n items - ints and fixed-size structs - over the "suspicious
+// array size" limits: FFDArrayCursor over a memory stream vs. Read().
+static void bench_huge(int n)
+{
+    BenchText d {};
+    d.Add ("type int 4" EOL EOL
+        "struct Vec" EOL "    int X" EOL "    int Y" EOL "    int Z" EOL EOL
+        "format F" EOL "    int Count" EOL "    int A[Count]" EOL
+        "    Vec V[Count]" EOL "    int Tail" EOL);
+    BenchData data {};
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++) data.Add (i, 4);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < 3; j++) data.Add (i + j, 4);
+    data.Add (42, 4);
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    double ms[2] {};
+    long long sum[2] {};
+    size_t used[2] {};
+    for (int i = 0; i < 2; i++) {
+        FFD_NS::FFDArena arena {};
+        ParseContext ctx {ffd};
+        ctx.Arena = &arena, ctx.HugeArrays = 1ll<<31;
+        FFD_NS::FFDMemoryStream m {data.Data (),
+            static_cast<size_t>(data.Len)};
+        BenchReader r {data.Data (), data.Len};
+        FFD_NS::Stream & s = i ? static_cast<FFD_NS::Stream &>(r) : m;
+        auto t = bench_ms ();
+        auto root = ffd.File2Tree (s, ctx);
+        FFD_ENSURE(42 == root->Get<int> ("Tail"), "bench: huge: wrong tail")
+        auto a = root->NodeByName ("A"), v = root->NodeByName ("V");
+        FFD_ENSURE(a->IsHuge () && v->IsHuge (), "bench: huge: read")
+        FFD_NS::FFDArrayCursor ca {a}, cv {v};
+        FFD_ENSURE(n == ca.Total () && n == cv.Total ()
+            && 12 == cv.ItemSize (), "bench: huge: wrong count")
+        while (ca.Next ())
+            for (int j = 0; j < ca.Count (); j++) sum[i] += ca.As<int> ()[j];
+        while (cv.Next ())
+            for (int j = 0; j < 3 * cv.Count (); j++)
+                sum[i] += cv.As<int> ()[j];
+        ms[i] = bench_ms () - t, used[i] = arena.Used ();
+        FFD_ENSURE(s.Tell () == data.Len, "bench: huge: stream moved")
+    }
+    long long items = n;
+    FFD_ENSURE(sum[0] == sum[1]
+        && sum[0] == 2 * items * (items - 1) + 3 * items,
+        "bench: huge: wrong values")
+    printf ("bench: File2Tree(2 arrays of %d items, %d bytes) + "
+        "FFDArrayCursor: memory: %.3f ms, %zu bytes; Read(): %.3f ms, %zu "
+        "bytes" EOL, n, data.Len, ms[0], used[0], ms[1], used[1]);
+}
+
+// n records of 2 read-until arrays - bytes and shorts, 16 to 4096 items:
+// FFDMemoryStream vs. Read().
+static void bench_until(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "struct Rec" EOL "    byte Name[-10]" EOL "    short Ids[-65535]" EOL
+        EOL "format F" EOL "    int Count" EOL "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        int len = 16 + static_cast<int>(
+            ((i * 2654435761ull) & 0xffffffffu) % 4081);
+        for (int j = 0; j < len; j++) data.Add ('a' + (i + j) % 26, 1);
+        data.Add (10, 1);
+        for (int j = 0; j < len; j++) data.Add ((i + j) & 0x7fff, 2);
+        data.Add (65535, 2);
+    }
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    double ms[2] {};
+    long items[2] {};
+    for (int r = 0; r < 3; r++)
+        for (int i = 0; i < 2; i++) {
+            FFD_NS::FFDArena arena {};
+            ParseContext ctx {ffd};
+            ctx.Arena = &arena;
+            FFD_NS::FFDMemoryStream m {data.Data (),
+                static_cast<size_t>(data.Len)};
+            BenchReader b {data.Data (), data.Len};
+            FFD_NS::Stream & s = i ? static_cast<FFD_NS::Stream &>(b) : m;
+            auto t = bench_ms ();
+            auto root = ffd.File2Tree (s, ctx);
+            ms[i] += bench_ms () - t;
+            FFD_ENSURE(s.Tell () == data.Len, "bench: not all data read")
+            items[i] = 0;
+            for (auto item : root->NodeByName ("Items")->Nodes ())
+                items[i] += item->NodeByName ("Name")->AsByteArray ()
+                    ->Length () + item->NodeByName ("Ids")->AsByteArray ()
+                    ->Length () / 2;
+        }
+    FFD_ENSURE(items[0] == items[1], "bench: until: values differ")
+    printf ("bench: File2Tree(%d read-until records, %d bytes, %ld items): "
+        "FFDMemoryStream: %.3f ms, Read(): %.3f ms" EOL, n, data.Len,
+        items[0], ms[0] / 3, ms[1] / 3);
+}
+
+// n records of implicit-dim and read-until arrays, over a stream that is not
+// an FFDMemoryStream: Read() only vs. Stream::Peek()/Borrow(); a tree, and
+// an FFDVisitor with an FFDProjection of no paths.
+static void bench_borrow(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "struct Vec" EOL "    int X" EOL "    int Y" EOL "    int Z" EOL EOL
+        "struct Rec" EOL "    byte Name[short]" EOL "    byte Tag[-10]" EOL
+        "    Vec P" EOL "    int Score" EOL EOL
+        "format F" EOL "    int Count" EOL "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        int name_len = 3 + i % 13, tag_len = 1 + i % 29;
+        data.Add (name_len, 2);
+        for (int j = 0; j < name_len; j++) data.Add ('a' + (i + j) % 26, 1);
+        for (int j = 0; j < tag_len; j++) data.Add ('A' + (i + j) % 26, 1);
+        data.Add (10, 1);
+        for (int j = 0; j < 3; j++) data.Add (i + j, 4);
+        data.Add (i, 4);
+    }
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    FFD_NS::FFDProjection deps {ffd, FFD_NS::List<FFD_NS::String> {}};
+    static const char * const MODE[2] {"tree", "FFDVisitor"};
+    double ms[2][2] {};
+    long copied[2][2] {}, sum[2][2] {};
+    for (int r = 0; r < 3; r++)
+        for (int j = 0; j < 2; j++)
+            for (int i = 0; i < 2; i++) {
+                FFD_NS::FFDArena arena {};
+                ParseContext ctx {ffd};
+                ctx.Arena = &arena;
+                BenchVisitor v {};
+                ctx.Projection = j ? &deps : nullptr;
+                ctx.Visitor = j ? &v : nullptr;
+                BenchReader s {data.Data (), data.Len, i > 0};
+                auto t = bench_ms ();
+                auto root = ffd.File2Tree (s, ctx);
+                ms[j][i] += bench_ms () - t;
+                FFD_ENSURE(s.Tell () == data.Len, "bench: not all data read")
+                if (! j) bench_count (root, v);
+                copied[j][i] = s.Copied, sum[j][i] = v.Sum;
+            }
+    for (int j = 0; j < 2; j++) {
+        FFD_ENSURE(sum[j][0] == sum[j][1], "bench: borrow: values differ")
+        printf ("bench: File2Tree(%d records, %d bytes), %s: Read(): "
+            "%.3f ms, %ld bytes copied; Peek()/Borrow(): %.3f ms, %ld bytes "
+            "copied" EOL, n, data.Len, MODE[j], ms[j][0] / 3, copied[j][0],
+            ms[j][1] / 3, copied[j][1]);
+    }
+}
+
+static unsigned int bench_hash_order(FFD_NS::FFDNode * root)
+{
+    unsigned int h = root->NodeByName ("Count")->AsInt ();
+    for (auto item : root->NodeByName ("Items")->Nodes ()) {
+        h = bench_mix (h, item->NodeByName ("K")->AsInt ());
+        if (auto extra = item->NodeByName ("Extra"))
+            h = bench_mix (h, extra->AsInt ());
+        auto p = item->NodeByName ("P")->AsArr<int> ();
+        for (int i = 0; i < 6; i++) h = bench_mix (h, p[i]);
+        auto ids = item->NodeByName ("Ids");
+        for (int i = 0; i < ids->NodeCount (); i++)
+            h = bench_mix (h, ids->IntArrElementAt (i));
+        h = bench_mix (h, item->NodeByName ("Name")->NodeCount ());
+        h = bench_mix (h, item->NodeByName ("Tag")->AsInt ());
+        h = bench_mix (h, item->NodeByName ("Score")->AsInt ());
+    }
+    return h;
+}
+
+// n records, the same values little- and big-endian: scalars, an enum in an
+// expression, an implicit dim, fixed-size struct items, a "little" type in
+// a "[ByteOrder(big)]" description - swapped as they're read.
+static void bench_byte_order(int n)
+{
+    static const char * const TEXT =
+        "type byte 1" EOL "type short 2" EOL "type int 4" EOL
+        "type tag 4 little" EOL EOL
+        "enum Kind short" EOL "    KA 1" EOL "    KB 2" EOL EOL
+        "struct Vec" EOL "    int X" EOL "    int Y" EOL "    int Z" EOL EOL
+        "struct Rec" EOL "    Kind K" EOL "    byte Name[short]" EOL
+        "    int Extra (K == KB)" EOL "    Vec P[2]" EOL "    short Len" EOL
+        "    short Ids[Len]" EOL "    tag Tag" EOL "    int Score" EOL EOL
+        "format F" EOL "    int Count" EOL "    Rec Items[Count]" EOL;
+    BenchText d[2] {};
+    d[0].Add (TEXT), d[1].Add ("[ByteOrder(big)]" EOL), d[1].Add (TEXT);
+    BenchData data[2] {};
+    for (int o = 0; o < 2; o++) {
+        auto & b = data[o];
+        b.Big = o > 0;
+        b.Add (n, 4);
+        for (int i = 0; i < n; i++) {
+            int k = 1 + (i & 1), name_len = 3 + i % 13, ids = i % 37;
+            b.Add (k, 2), b.Add (name_len, 2);
+            for (int j = 0; j < name_len; j++) b.Add ('a' + j, 1);
+            if (2 == k) b.Add (i * 7, 4);
+            for (int j = 0; j < 6; j++) b.Add (i * 1000 + j - 3, 4);
+            b.Add (ids, 2);
+            for (int j = 0; j < ids; j++) b.Add ((i + j) & 0xffff, 2);
+            b.Big = false, b.Add (i ^ 0x5a5a, 4), b.Big = o > 0;
+            b.Add (-i, 4);
+        }
+    }
+    double ms[2][2] {};
+    unsigned int h[2][2] {};
+    for (int c = 0; c < 2; c++)
+        for (int o = 0; o < 2; o++) {
+            FFD_NS::FFD ffd {d[o].Data (), d[o].Len};
+            if (c) ffd.Compile ();
+            for (int r = 0; r < 3; r++) {
+                FFD_NS::FFDArena arena {};
+                ParseContext ctx {ffd};
+                ctx.Arena = &arena;
+                FFD_NS::FFDMemoryStream s {data[o].Data (),
+                    static_cast<size_t>(data[o].Len)};
+                auto t = bench_ms ();
+                auto root = ffd.File2Tree (s, ctx);
+                ms[c][o] += bench_ms () - t;
+                FFD_ENSURE(s.Tell () == data[o].Len, "bench: not all data read")
+                h[c][o] = bench_hash_order (root);
+            }
+        }
+    FFD_ENSURE(h[0][0] == h[0][1] && h[0][0] == h[1][0] && h[0][0] == h[1][1],
+        "bench: byte order: values differ")
+    for (int c = 0; c < 2; c++)
+        printf ("bench: File2Tree(%d records, %d bytes), %s: host byte order: "
+            "%.3f ms; swapped: %.3f ms" EOL, n, data[0].Len,
+            c ? "compiled" : "tree-walk", ms[c][0] / 3, ms[c][1] / 3);
+}
+
+// n records of 9 fields; each one looked up by name in each record: String
+// names made once, literals, and Get<T>().
+static void bench_lookup(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "struct Rec" EOL "    int Id" EOL "    byte Kind" EOL "    short Len"
+        EOL "    int Extra (Kind == 2)" EOL "    int X" EOL "    int Y" EOL
+        "    int Z" EOL "    byte Name[Len]" EOL "    int Score" EOL EOL
+        "format F" EOL "    int Count" EOL "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++) {
+        int k = 1 + (i & 1), len = 1 + i % 7;
+        data.Add (i, 4), data.Add (k, 1), data.Add (len, 2);
+        if (2 == k) data.Add (i * 3, 4);
+        for (int j = 0; j < 3; j++) data.Add (i + j, 4);
+        for (int j = 0; j < len; j++) data.Add ('a' + j, 1);
+        data.Add (-i, 4);
+    }
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    FFD_NS::FFDArena arena {};
+    ParseContext ctx {ffd};
+    ctx.Arena = &arena;
+    FFD_NS::FFDMemoryStream s {data.Data (), static_cast<size_t>(data.Len)};
+    auto root = ffd.File2Tree (s, ctx);
+    static const char * const NAMES[9] {"Id", "Kind", "Len", "Extra", "X",
+        "Y", "Z", "Name", "Score"};
+    FFD_NS::List<FFD_NS::String> names {};
+    for (auto name : NAMES) names.Add (name);
+    int ids[9] {};
+    for (int i = 0; i < 9; i++) ids[i] = root->NameId (NAMES[i]);
+    double ms[4] {};
+    long sum[4] {};
+    for (int r = 0; r < 3; r++) {
+        auto t = bench_ms ();
+        for (auto item : root->NodeByName ("Items")->Nodes ())
+            for (auto & name : names)
+                sum[0] += nullptr != item->NodeByName (name);
+        ms[0] += bench_ms () - t, t = bench_ms ();
+        for (auto item : root->NodeByName ("Items")->Nodes ())
+            for (auto name : NAMES)
+                sum[1] += nullptr != item->NodeByName (name);
+        ms[1] += bench_ms () - t, t = bench_ms ();
+        for (auto item : root->NodeByName ("Items")->Nodes ())
+            for (auto id : ids)
+                sum[3] += nullptr != item->NodeByName (id);
+        ms[3] += bench_ms () - t, t = bench_ms ();
+        for (auto item : root->NodeByName ("Items")->Nodes ())
+            sum[2] += item->Get<int> ("Id") + item->Get<int> ("Extra")
+                + item->Get<int> ("Score");
+        ms[2] += bench_ms () - t;
+    }
+    long extra {};
+    for (int i = 1; i < n; i += 2) extra += 3l * i;
+    FFD_ENSURE(sum[0] == sum[1] && sum[0] == sum[3]
+        && 3l * (9 * n - (n + 1) / 2) == sum[0] && 3 * extra == sum[2],
+        "bench: lookup: wrong values")
+    printf ("bench: NodeByName(%d records x 9 fields): String: %.3f ms, "
+        "literal: %.3f ms, NameId: %.3f ms; Get<int>() x 3: %.3f ms" EOL, n,
+        ms[0] / 3, ms[1] / 3, ms[3] / 3, ms[2] / 3);
+}
+
+// "Header.Blocks[2].Size", split and looked up by name - per tree.
+static FFD_NS::FFDNode * bench_by_path(FFD_NS::FFDNode * n, const char * path)
+{
+    FFD_NS::String copy {path};
+    for (auto & s : copy.Split ('.')) {
+        auto z = s.AsZStr ();
+        int b {};
+        while (z[b] && '[' != z[b]) b++;
+        n = n->NodeByName (FFD_NS::String {reinterpret_cast<const byte *>(z),
+            b});
+        if (nullptr == n) return nullptr;
+        if (! z[b]) continue;
+        int i {};
+        while (z[++b] >= '0' && z[b] <= '9') i = 10 * i + z[b] - '0';
+        if (i >= n->NodeCount ()) return nullptr;
+        n = (*n)[i];
+    }
+    return n;
+}
+
+// n files, 8 paths out of each: by name vs. FFD::CompilePath().
+static void bench_path(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+        "struct HInfo" EOL "    short Version" EOL "    int Flags" EOL EOL
+        "struct Header" EOL "    int Magic" EOL "    HInfo Info" EOL
+        "    byte Kind" EOL EOL
+        "struct Block" EOL "    byte Len" EOL "    byte Data[Len]" EOL
+        "    int Size" EOL EOL
+        "format F" EOL "    Header Header" EOL "    int Count" EOL
+        "    Block Blocks[Count]" EOL);
+    BenchData data {};
+    FFD_NS::List<int> at {};
+    for (int i = 0; i < n; i++) {
+        at.Add (data.Len);
+        data.Add (i, 4), data.Add (i % 7, 2), data.Add (2 * i, 4);
+        data.Add (1, 1), data.Add (3, 4);
+        for (int j = 0; j < 3; j++) {
+            data.Add (j + 1, 1);
+            for (int k = 0; k <= j; k++) data.Add ('a' + k, 1);
+            data.Add (i + j, 4);
+        }
+    }
+    at.Add (data.Len);
+    static const char * const PATHS[8] {"Header.Magic",
+        "Header.Info.Version", "Header.Info.Flags", "Header.Kind", "Count",
+        "Blocks[0].Size", "Blocks[2].Size", "Blocks[2].Len"};
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    auto t = bench_ms ();
+    FFD_NS::List<FFD_NS::FFD::Path> paths {};
+    for (auto p : PATHS) paths.Add (ffd.CompilePath (p));
+    double compile = bench_ms () - t;
+    FFD_NS::FFDArena arena {};
+    ParseContext ctx {ffd};
+    ctx.Arena = &arena;
+    double ms[2] {};
+    long sum[2] {}, expected {};
+    for (int i = 0; i < n; i++) {
+        arena.Reset (), ctx.Reset ();
+        FFD_NS::FFDMemoryStream s {data.Data () + at[i],
+            static_cast<size_t>(at[i + 1] - at[i])};
+        auto root = ffd.File2Tree (s, ctx);
+        t = bench_ms ();
+        for (auto p : PATHS) sum[0] += bench_by_path (root, p)->AsInt ();
+        ms[0] += bench_ms () - t, t = bench_ms ();
+        for (auto & p : paths) sum[1] += root->Get<int> (p);
+        ms[1] += bench_ms () - t;
+        expected += 5l * i + i % 7 + 9;
+    }
+    FFD_ENSURE(expected == sum[0] && expected == sum[1],
+        "bench: path: wrong values")
+    printf ("bench: 8 paths x %d trees: by name: %.3f ms; CompilePath(): "
+        "%.3f ms (%.3f ms to compile)" EOL, n, ms[0], ms[1], compile);
+}
+
+// An h3m-like tile layer: n fixed-size structs, one FFDNode each vs. viewed
+// in place.
+static void bench_struct_array(int n)
+{
+    BenchText d[2] {};
+    for (int i = 0; i < 2; i++)
+        d[i].Add ("type byte 1" EOL "type short 2" EOL "type int 4" EOL EOL
+            "struct Tile" EOL "    byte Terrain" EOL "    byte Kind" EOL
+            "%s"
+            "    short Road" EOL "    byte Flags[3]" EOL EOL
+            "format F" EOL "    int Count" EOL "    Tile Tiles[Count]" EOL,
+            // never there; but the items are no longer of a fixed size
+            i ? "" : "    byte Pad (Kind == 99)" EOL);
+    BenchData data {};
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++)
+        data.Add (i % 9, 1), data.Add (1 + i % 3, 1), data.Add (i % 999, 2),
+        data.Add (1, 1), data.Add (2, 1), data.Add (i & 1, 1);
+    double ms[2] {};
+    size_t peak[2] {};
+    long sum[2] {};
+    for (int i = 0; i < 2; i++) {
+        FFD_NS::FFD ffd {d[i].Data (), d[i].Len};
+        FFD_NS::FFDArena arena {};
+        ParseContext ctx {ffd};
+        ctx.Arena = &arena;
+        for (int r = 0; r < 3; r++) {
+            arena.Reset (), ctx.Reset ();
+            FFD_NS::FFDMemoryStream s {data.Data (),
+                static_cast<size_t>(data.Len)};
+            auto t = bench_ms ();
+            auto tiles = ffd.File2Tree (s, ctx)->NodeByName ("Tiles");
+            if (i) {
+                FFD_NS::FFDStructArray a {tiles};
+                int terrain = a.IndexOf ("Terrain"), road = a.IndexOf ("Road"),
+                    flags = a.IndexOf ("Flags");
+                for (int j = 0; j < a.Count (); j++)
+                    sum[i] += a.AsInt (j, terrain) + a.AsInt (j, road)
+                        + a.AsInt (j, flags, 2);
+            }
+            else
+                for (auto tile : tiles->Nodes ())
+                    sum[i] += tile->Get<int> ("Terrain")
+                        + tile->Get<int> ("Road")
+                        + tile->NodeByName ("Flags")->IntArrElementAt (2);
+            ms[i] += bench_ms () - t;
+        }
+        peak[i] = arena.Peak ();
+    }
+    FFD_ENSURE(sum[0] == sum[1], "bench: struct array: wrong values")
+    printf ("bench: File2Tree(%d fixed-size structs) + 3 fields each: "
+        "FFDNode-s: %.3f ms, %zu bytes; FFDStructArray: %.3f ms, %zu bytes"
+        EOL, n, ms[0] / 3, peak[0], ms[1] / 3, peak[1]);
+}
+
+// A 2-level h3m-like tile map, "TTile Tiles[2][N][N]": the offsets by hand
+// vs. FFDArrayView; tree-walk and compiled.
+static void bench_array_view(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type short 2" EOL EOL "const N %d" EOL EOL
+        "struct TTile" EOL "    byte Terrain" EOL "    byte Kind" EOL
+        "    short Road" EOL EOL
+        "format F" EOL "    TTile Tiles[2][N][N]" EOL, n);
+    BenchData data {};
+    for (int i = 0; i < 2 * n * n; i++)
+        data.Add (i % 9, 1), data.Add (1, 1), data.Add (i % 999, 2);
+    double ms[2][3] {};
+    long sum[2][3] {};
+    for (int c = 0; c < 2; c++) {
+        FFD_NS::FFD ffd {d.Data (), d.Len};
+        if (c) ffd.Compile ();
+        FFD_NS::FFDArena arena {};
+        ParseContext ctx {ffd};
+        ctx.Arena = &arena;
+        FFD_NS::FFDMemoryStream s {data.Data (),
+            static_cast<size_t>(data.Len)};
+        auto node = ffd.File2Tree (s, ctx)->NodeByName ("Tiles");
+        FFD_NS::FFDStructArray tiles {node};
+        int terrain = tiles.IndexOf ("Terrain");
+        for (int r = 0; r < 3; r++) {
+            auto t = bench_ms ();
+            for (int z = 0; z < 2; z++)
+                for (int y = 0; y < n; y++)
+                    for (int x = 0; x < n; x++)
+                        sum[c][0] += tiles.AsInt ((z * n + y) * n + x,
+                            terrain);
+            ms[c][0] += bench_ms () - t, t = bench_ms ();
+            FFD_NS::FFDArrayView map {node};
+            FFD_ENSURE(3 == map.Dims () && 2 == map.Extent (0)
+                && n == map.Extent (1) && n == map.Extent (2),
+                "bench: array view: wrong extents")
+            for (int z = 0; z < 2; z++)
+                for (int y = 0; y < n; y++)
+                    for (int x = 0; x < n; x++)
+                        sum[c][1] += tiles.AsInt (map.Index (z, y, x),
+                            terrain);
+            ms[c][1] += bench_ms () - t, t = bench_ms ();
+            map.ForEach ([&](int i) {
+                sum[c][2] += tiles.AsInt (i, terrain);
+            });
+            ms[c][2] += bench_ms () - t;
+        }
+        // the 2nd level, every 3rd row, the last column
+        FFD_NS::FFDArrayView map {node};
+        long slice {}, by_hand {};
+        map.Sub (1).Slice (0, 0, (n + 2) / 3, 3).Slice (1, n - 1, 1)
+            .ForEach ([&](int i) { slice += tiles.AsInt (i, terrain); });
+        for (int y = 0; y < n; y += 3)
+            by_hand += tiles.AsInt ((n + y) * n + n - 1, terrain);
+        FFD_ENSURE(slice == by_hand, "bench: array view: wrong slice")
+    }
+    for (int c = 0; c < 2; c++)
+        FFD_ENSURE(sum[c][0] == sum[c][1] && sum[c][0] == sum[c][2]
+            && sum[0][0] == sum[c][0], "bench: array view: wrong values")
+    printf ("bench: TTile[2][%d][%d], Terrain: tree-walk: by hand: %.3f ms, "
+        "Index(): %.3f ms, ForEach(): %.3f ms; compiled: %.3f, %.3f, %.3f ms"
+        EOL, n, n, ms[0][0] / 3, ms[0][1] / 3, ms[0][2] / 3, ms[1][0] / 3,
+        ms[1][1] / 3, ms[1][2] / 3);
+}
+
+// Items of an array resolved by name - "... struct.Nm" - visited with an
+// FFDArena: the unprojected items are on the stack; arena.Reset() after
+// each input.
+static void bench_visitor_arena(int n)
+{
+    BenchText d {};
+    d.Add ("type byte 1" EOL "type int 4" EOL EOL
+        "struct Name" EOL "    byte Text[4]" EOL EOL
+        "struct Abcd" EOL "    int V" EOL "    byte K" EOL EOL
+        "struct Item" EOL "    ... struct.Nm" EOL EOL
+        "format F" EOL "    Name Nm" EOL "    int Count" EOL
+        "    Item Items[Count]" EOL);
+    BenchData data {};
+    data.Add ('A', 1), data.Add ('b', 1), data.Add ('c', 1), data.Add ('d', 1);
+    data.Add (n, 4);
+    for (int i = 0; i < n; i++) data.Add (i, 4), data.Add (i & 7, 1);
+    double ms[2][2] {};
+    for (int c = 0; c < 2; c++) {
+        FFD_NS::FFD ffd {d.Data (), d.Len};
+        if (c) ffd.Compile ();
+        FFD_NS::FFDProjection deps {ffd, FFD_NS::List<FFD_NS::String> {}};
+        FFD_NS::FFDArena arena {};
+        ParseContext ctx {ffd};
+        ctx.Arena = &arena;
+        BenchVisitor expected {}, v {};
+        for (int r = 0; r < 3; r++)
+            for (int i = 0; i < 2; i++) {
+                arena.Reset (), ctx.Reset ();
+                ctx.Projection = i ? &deps : nullptr;
+                ctx.Visitor = i ? &v : nullptr;
+                v = BenchVisitor {};
+                FFD_NS::FFDMemoryStream s {data.Data (),
+                    static_cast<size_t>(data.Len)};
+                auto t = bench_ms ();
+                auto tree = ffd.File2Tree (s, ctx);
+                if (! i && ! r) bench_count (tree, expected);
+                ms[c][i] += bench_ms () - t;
+                FFD_ENSURE(s.Tell () == data.Len, "bench: not all data read")
+            }
+        arena.Reset ();
+        FFD_ENSURE(expected.Nodes == v.Nodes && expected.Bytes == v.Bytes
+            && expected.Sum == v.Sum && 0 == v.Depth,
+            "bench: visitor arena: not the same fields")
+    }
+    printf ("bench: File2Tree(%d items by struct name), arena: tree-walk: "
+        "%.3f ms, FFDVisitor: %.3f ms; compiled: %.3f ms, %.3f ms" EOL, n,
+        ms[0][0] / 3, ms[0][1] / 3, ms[1][0] / 3, ms[1][1] / 3);
+}
+
+// Ordered, many small files: the arenas hold the trees waiting to be
+// reported - not the ones reported. Open() keeps a worker at most AHEAD
+// files past the next one to report; the file names are the indices.
+class BenchOrderedClient final : public FFD_NS::FFDCorpus::Client
+{
+    public: static int const AHEAD {8};
+    public: BenchOrderedClient(int workers, const byte * data, int len)
+    {
+        for (int i = 0; i < workers; i++) _s.Add (BenchStream {data, len});
+    }
+    public: FFD_NS::Stream * Open(int worker, const char * n) override
+    {
+        int job = atoi (n);
+        while (job - __atomic_load_n (&Reported, __ATOMIC_ACQUIRE) > AHEAD)
+            sched_yield ();
+        return &(_s[worker].Reset ());
+    }
+    public: void Parsed(const FFD_NS::FFDCorpus::Result & r) override
+    {
+        if (! r.Tree || r.Index != Reported) Failed++;
+        __atomic_add_fetch (&Reported, 1, __ATOMIC_RELEASE);
+    }
+    public: int Reported {}, Failed {};
+    private: FFD_NS::List<BenchStream> _s {};
+};
+static void bench_corpus_ordered(int files)
+{
+    const int WORKERS {4}, RECORDS {1000};
+    BenchText d {};
+    d.Add ("type int 4" EOL EOL
+        "struct Rec" EOL "    int A" EOL "    int B" EOL EOL
+        "format F" EOL "    int Count" EOL "    Rec Items[Count]" EOL);
+    BenchData data {};
+    data.Add (RECORDS, 4);
+    for (int i = 0; i < RECORDS; i++) data.Add (i, 4), data.Add (-i, 4);
+    FFD_NS::FFD ffd {d.Data (), d.Len};
+    ffd.Compile ();
+    FFD_NS::FFDArena one {1<<16};
+    {
+        ParseContext ctx {ffd};
+        ctx.Arena = &one;
+        BenchStream s {data.Data (), data.Len};
+        ffd.File2Tree (s, ctx);
+    }
+    FFD_NS::FFDCorpus corpus {ffd, WORKERS};
+    for (int i = 0; i < files; i++) {
+        char n[16];
+        snprintf (n, sizeof(n), "%d", i);
+        corpus.Add (n);
+    }
+    BenchOrderedClient client {corpus.Workers (), data.Data (), data.Len};
+    auto t = bench_ms ();
+    corpus.Run (client, /*ordered:*/true);
+    t = bench_ms () - t;
+    FFD_ENSURE(files == client.Reported && ! client.Failed,
+        "bench: FFDCorpus: ordered: wrong order")
+    // the trees waiting, the ones parsed, and the arenas left free by them
+    int const BOUND {2 * (BenchOrderedClient::AHEAD + 1) + WORKERS};
+    printf ("bench: FFDCorpus ordered x %d files, %d workers: %.3f ms; arenas: "
+        "%zu bytes; %zu bytes a tree" EOL, files, WORKERS, t,
+        corpus.ArenaReserved (), one.Peak ());
+    FFD_ENSURE(corpus.ArenaReserved () <= BOUND * one.Reserved (),
+        "bench: FFDCorpus: ordered: the arenas grow with the files")
+}
+
+void bench_the_works()
+{
+    bench_description_load (10000);
+    bench_decode (100000);
+    bench_conditions (100000);
+    bench_lazy (100000);
+    bench_projection (100000);
+    bench_huge ((1<<22) + 1);
+    bench_until (4096);
+    bench_borrow (100000);
+    bench_byte_order (100000);
+    bench_lookup (100000);
+    bench_path (100000);
+    bench_struct_array (41472);
+    bench_array_view (144);
+    bench_visitor_arena (100000);
+    bench_corpus_ordered (2048);
+}
\ No newline at end of file